@@ -0,0 +1,103 @@
+#ifndef BENCHCOMMON_HPP
+#define BENCHCOMMON_HPP
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cstdio>
+#include "DatabaseManager.hpp"
+
+namespace StudentPicker {
+namespace Bench {
+
+// Own settings and data location, a benchmark never touches the app's
+// config or database. Logger output is dropped, it would dominate timings.
+inline void setup(const QString& name) {
+    QCoreApplication::setApplicationName("StudentPickerBench-" + name);
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext&, const QString& message) {
+        if (type != QtDebugMsg && type != QtInfoMsg) {
+            std::fprintf(stderr, "%s\n", qPrintable(message));
+        }
+    });
+}
+
+// Fresh database file in the temp directory, with WAL leftovers removed
+inline QString databasePath(const QString& name) {
+    QString path = QDir::temp().filePath("studentpicker-bench-" + name + ".db");
+    for (const QString& suffix : {QString(), QString("-wal"), QString("-shm")}) {
+        QFile::remove(path + suffix);
+    }
+    return path;
+}
+
+// Deterministic roster, names repeat like a real school does
+inline QVector<Student> makeStudents(int count, int classCount, quint32 seed = 24) {
+    static const QStringList firstNames = {
+        "Budi", "Siti", "Agus", "Dewi", "Rizky", "Putri", "Andi", "Ayu", "Fajar", "Nur",
+        "Bayu", "Intan", "Dimas", "Sari", "Yoga", "Wulan", "Hendra", "Lestari", "Eko", "Maya"
+    };
+    static const QStringList lastNames = {
+        "Santoso", "Wijaya", "Saputra", "Hidayat", "Pratama", "Kusuma", "Lestari", "Nugroho",
+        "Setiawan", "Rahmawati", "Gunawan", "Purnomo", "Susanto", "Halim", "Siregar", "Nasution"
+    };
+
+    QRandomGenerator rng(seed);
+    QVector<Student> students;
+    students.reserve(count);
+
+    for (int i = 0; i < count; i++) {
+        Student student;
+        student.name = firstNames[rng.bounded(firstNames.size())] + " " +
+                       lastNames[rng.bounded(lastNames.size())] + " " +
+                       lastNames[rng.bounded(lastNames.size())];
+        student.studentId = QString("S%1").arg(i, 7, 10, QChar('0'));
+        student.className = QString("Class %1").arg(i % classCount + 1, 2, 10, QChar('0'));
+        students.append(student);
+    }
+    return students;
+}
+
+// Bulk insert through the import session, the path the app imports with
+inline bool populate(DatabaseManager& db, const QVector<Student>& students, int batchSize = 1000) {
+    if (!db.beginImport()) {
+        return false;
+    }
+    for (int i = 0; i < students.size(); i += batchSize) {
+        if (!db.importStudentsBatch(students.mid(i, batchSize))) {
+            db.finishImport(false);
+            return false;
+        }
+    }
+    return db.finishImport(true);
+}
+
+// Best of several runs in milliseconds
+template<typename Fn>
+double bestOf(int runs, Fn fn) {
+    double best = -1;
+    for (int i = 0; i < runs; i++) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        double ms = timer.nsecsElapsed() / 1e6;
+        if (best < 0 || ms < best) {
+            best = ms;
+        }
+    }
+    return best;
+}
+
+inline void report(const QString& label, double ms, const QString& extra = QString()) {
+    std::printf("%-48s %10.2f ms  %s\n", qPrintable(label), ms, qPrintable(extra));
+    std::fflush(stdout);
+}
+
+} // namespace Bench
+} // namespace StudentPicker
+
+#endif // BENCHCOMMON_HPP
@@ -0,0 +1,159 @@
+// CSVReader (mapped file + CSVTokenizer) against the QTextStream + parseLine
+// reader it replaced, on a roster CSV of several hundred MB on disk.
+// Usage: bench_csv_tokenizer [size in MB, default 400]
+#include "BenchCommon.hpp"
+#include "CSVReader.hpp"
+#include <QFileInfo>
+#include <QTextStream>
+#include <QVariantMap>
+
+using namespace StudentPicker;
+
+namespace {
+
+const int DEFAULT_SIZE_MB = 400;
+const int BLOCK_ROWS = 100000;
+const int RUNS = 3;
+
+// Roster with a BOM and a header, every tenth name quoted with an embedded
+// comma. One block of rows is repeated until the file reaches targetBytes.
+bool writeCsv(const QString& path, qint64 targetBytes) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QByteArray block;
+    const QVector<Student> students = Bench::makeStudents(BLOCK_ROWS, 40);
+    for (int i = 0; i < students.size(); i++) {
+        const Student& student = students[i];
+        if (i % 10 == 0) {
+            block += "\"" + student.name.toUtf8() + ", Jr.\"";
+        } else {
+            block += student.name.toUtf8();
+        }
+        block += "," + student.studentId.toUtf8() + "," + student.className.toUtf8() + "\n";
+    }
+
+    if (file.write("\xEF\xBB\xBFName,StudentID,Class\n") < 0) {
+        return false;
+    }
+    while (file.size() < targetBytes) {
+        if (file.write(block) != block.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The line parser CSVReader used before the tokenizer
+QStringList parseLine(const QString& line, QChar delimiter) {
+    QStringList fields;
+    QString currentField;
+    bool inQuotes = false;
+
+    for (int i = 0; i < line.length(); i++) {
+        QChar c = line[i];
+
+        if (c == '"') {
+            inQuotes = !inQuotes;
+        } else if (c == delimiter && !inQuotes) {
+            fields.append(currentField.trimmed());
+            currentField.clear();
+        } else {
+            currentField.append(c);
+        }
+    }
+
+    fields.append(currentField.trimmed());
+    return fields;
+}
+
+// The old CSVReader::readFile: QTextStream over the file, one parseLine per
+// line, rows handed over in batches of the same size CSVReader uses
+qint64 readWithParseLine(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+
+    QTextStream in(&file);
+    in.setEncoding(QStringConverter::Utf8);
+
+    QStringList headers;
+    QVector<QVariantMap> batch;
+    batch.reserve(CSVReader::DEFAULT_BATCH_SIZE);
+    qint64 rows = 0;
+
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QStringList fields = parseLine(line, ',');
+        if (headers.isEmpty()) {
+            headers = fields;
+            continue;
+        }
+        if (fields.size() != headers.size()) {
+            continue;
+        }
+
+        QVariantMap row;
+        for (int i = 0; i < headers.size(); i++) {
+            row[headers[i]] = fields[i];
+        }
+        batch.append(row);
+
+        if (batch.size() >= CSVReader::DEFAULT_BATCH_SIZE) {
+            rows += batch.size();
+            batch.clear();
+        }
+    }
+    return rows + batch.size();
+}
+
+qint64 readWithCSVReader(const QString& path) {
+    CSVReader reader;
+    qint64 rows = 0;
+    bool ok = reader.readFile(path, [&rows](const QVector<QVariantMap>& batch) {
+        rows += batch.size();
+        return true;
+    });
+    return ok ? rows : -1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    Bench::setup("csv");
+
+    const int sizeMb = argc > 1 ? QString(argv[1]).toInt() : DEFAULT_SIZE_MB;
+    if (sizeMb <= 0) {
+        std::fprintf(stderr, "Invalid size: %s\n", argv[1]);
+        return 1;
+    }
+
+    const QString path = QDir::temp().filePath("studentpicker-bench-roster.csv");
+    if (!writeCsv(path, qint64(sizeMb) * 1024 * 1024)) {
+        std::fprintf(stderr, "Cannot write %s\n", qPrintable(path));
+        QFile::remove(path);
+        return 1;
+    }
+    const double megabytes = QFileInfo(path).size() / (1024.0 * 1024.0);
+    std::printf("%s: %.1f MB\n", qPrintable(path), megabytes);
+
+    qint64 rows = 0;
+    double before = Bench::bestOf(RUNS, [&]() { rows = readWithParseLine(path); });
+    Bench::report("QTextStream + parseLine", before,
+                  QString("%1 rows, %2 MB/s").arg(rows).arg(megabytes / (before / 1000), 0, 'f', 1));
+
+    double after = Bench::bestOf(RUNS, [&]() { rows = readWithCSVReader(path); });
+    Bench::report("CSVReader::readFile (mmap + CSVTokenizer)", after,
+                  QString("%1 rows, %2 MB/s").arg(rows).arg(megabytes / (after / 1000), 0, 'f', 1));
+
+    QFile::remove(path);
+    return 0;
+}
@@ -0,0 +1,79 @@
+// The performance and safe database profiles side by side: bulk import,
+// single-row updateStudent commits and keyset paged reads
+#include "BenchCommon.hpp"
+#include "userPreference.hpp"
+
+using namespace StudentPicker;
+
+namespace {
+
+const int STUDENT_COUNT = 40000;
+const int CLASS_COUNT = 40;
+const int UPDATE_COUNT = 500;
+const int PAGE_SIZE = 200;
+const int RUNS = 3;
+
+bool runProfile(const QString& profile) {
+    UserConfig::instance().setValue(UserConfig::KEY_DATABASE_PROFILE, profile);
+
+    DatabaseManager& db = DatabaseManager::instance();
+    if (!db.initDb(Bench::databasePath("profile-" + profile))) {
+        std::fprintf(stderr, "setup failed: %s\n", qPrintable(db.getLastError()));
+        return false;
+    }
+
+    // A fresh file each time, so one run only
+    const QVector<Student> students = Bench::makeStudents(STUDENT_COUNT, CLASS_COUNT);
+    bool ok = true;
+    double insertMs = Bench::bestOf(1, [&]() { ok = Bench::populate(db, students); });
+    if (!ok) {
+        std::fprintf(stderr, "import failed: %s\n", qPrintable(db.getLastError()));
+        db.closeDb();
+        return false;
+    }
+    Bench::report(profile + ": bulk import", insertMs, QString("%1 rows").arg(STUDENT_COUNT));
+
+    // Every call is its own transaction, the commit cost is what differs
+    QVector<Student> targets;
+    for (int i = 0; i < UPDATE_COUNT; i++) {
+        targets.append(db.getStudentId(1 + i * (STUDENT_COUNT / UPDATE_COUNT)));
+    }
+    double updateMs = Bench::bestOf(1, [&]() {
+        for (Student student : targets) {
+            student.name += " ";
+            ok = db.updateStudent(student) && ok;
+        }
+    });
+    Bench::report(profile + ": updateStudent", updateMs,
+                  QString("%1 calls, %2 ms each%3")
+                      .arg(UPDATE_COUNT)
+                      .arg(updateMs / UPDATE_COUNT, 0, 'f', 3)
+                      .arg(ok ? "" : ", FAILED"));
+
+    int pages = 0;
+    double readMs = Bench::bestOf(RUNS, [&]() {
+        pages = 0;
+        QVector<StudentSummary> page = db.getStudentSummariesPage(-1, 0, PAGE_SIZE);
+        while (!page.isEmpty()) {
+            pages++;
+            const StudentSummary& last = page.last();
+            page = db.getStudentSummariesAfter(-1, last.name, last.id, PAGE_SIZE);
+        }
+    });
+    Bench::report(profile + ": paged reads", readMs, QString("%1 pages of %2").arg(pages).arg(PAGE_SIZE));
+
+    db.closeDb();
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    Bench::setup("profile");
+
+    bool ok = runProfile("performance");
+    ok = runProfile("safe") && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// Encode count and result size of ImageProcessor::getCompressedData against
+// the quality stepping it replaced, on synthetic photos
+#include "BenchCommon.hpp"
+#include "ImageProcessor.hpp"
+#include "global.hpp"
+#include <QBuffer>
+#include <QImage>
+
+using namespace StudentPicker;
+
+namespace {
+
+const int RUNS = 3;
+
+struct Photo {
+    int width;
+    int height;
+    int noise;
+};
+
+// Gradient with per-pixel noise, more noise means a larger JPEG
+QImage makePhoto(const Photo& photo, quint32 seed = 17) {
+    QImage image(photo.width, photo.height, QImage::Format_RGB32);
+    QRandomGenerator random(seed);
+
+    for (int y = 0; y < photo.height; y++) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < photo.width; x++) {
+            const int base = (x + y) * 255 / (photo.width + photo.height);
+            const int r = base + int(random.bounded(2 * photo.noise + 1)) - photo.noise;
+            const int g = 255 - base + int(random.bounded(2 * photo.noise + 1)) - photo.noise;
+            const int b = 128 + int(random.bounded(2 * photo.noise + 1)) - photo.noise;
+            line[x] = qRgb(qBound(0, r, 255), qBound(0, g, 255), qBound(0, b, 255));
+        }
+    }
+    return image;
+}
+
+QByteArray toJpeg(const QImage& image, int quality) {
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "JPEG", quality);
+    return data;
+}
+
+// The search before the bisection: quality down in steps of 10, then one
+// 80% resize at the starting quality
+QByteArray compressStepped(const QImage& image, int targetSizeKB, int quality, int& encodes) {
+    QByteArray data = toJpeg(image, quality);
+    encodes = 1;
+
+    int currentQuality = quality;
+    while (data.size() / 1024 > targetSizeKB && currentQuality > 20) {
+        currentQuality -= 10;
+        data = toJpeg(image, currentQuality);
+        encodes++;
+    }
+
+    if (data.size() / 1024 > targetSizeKB) {
+        QImage resized = image.scaled(image.width() * 0.8, image.height() * 0.8,
+                                      Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        data = toJpeg(resized, quality);
+        encodes++;
+    }
+    return data;
+}
+
+QString describe(const QByteArray& data, int encodes, int targetSizeKB) {
+    const QImage result = QImage::fromData(data);
+    return QString("%1 encodes, %2 KB, %3x%4%5")
+        .arg(encodes)
+        .arg(data.size() / 1024.0, 0, 'f', 1)
+        .arg(result.width())
+        .arg(result.height())
+        .arg(data.size() > qint64(targetSizeKB) * 1024 ? ", OVER TARGET" : "");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    Bench::setup("image");
+
+    // The app's limit, and a tight one that forces the resize path
+    const QVector<int> targets = {GlobalConf::MAX_IMAGE_SIZE_KB, 100};
+    const QVector<Photo> photos = {
+        {800, 600, 8}, {1200, 900, 24}, {1200, 1200, 48}, {1200, 1200, 127},
+    };
+
+    for (const Photo& photo : photos) {
+        const QImage image = makePhoto(photo);
+
+        // Loaded the way the importer loads a file
+        QByteArray source;
+        QBuffer buffer(&source);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "BMP");
+
+        ImageProcessor processor;
+        processor.loadFromData(source);
+
+        for (int targetSizeKB : targets) {
+            const QString label = QString("%1x%2 noise %3 -> %4 KB")
+                                      .arg(photo.width).arg(photo.height).arg(photo.noise).arg(targetSizeKB);
+
+            QByteArray before;
+            int beforeEncodes = 0;
+            double beforeMs = Bench::bestOf(RUNS, [&]() {
+                before = compressStepped(image, targetSizeKB, 85, beforeEncodes);
+            });
+            Bench::report(label + ", stepped", beforeMs, describe(before, beforeEncodes, targetSizeKB));
+
+            QByteArray after;
+            double afterMs = Bench::bestOf(RUNS, [&]() {
+                after = processor.getCompressedData(targetSizeKB);
+            });
+            Bench::report(label + ", bisection", afterMs,
+                          after.isEmpty() ? processor.getLastError()
+                                          : describe(after, processor.getEncodeCount(), targetSizeKB));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Student search through the FTS5 trigram index against the LIKE scan it
+// falls back to, at 10k, 100k and 1M rows
+#include "BenchCommon.hpp"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QVariant>
+
+using namespace StudentPicker;
+
+namespace {
+
+const int CLASS_COUNT = 40;
+const int RUNS = 5;
+const QString LIKE_CONNECTION_NAME = "bench-like";
+
+// Keyword at the start of names, and one in the middle of them
+const QVector<QPair<QString, QString>> KEYWORDS = {
+    {"prefix", "Budi Santoso"},
+    {"substring", "toso Wija"},
+};
+
+// The fallback's query, run on a second connection so the manager keeps
+// using the index
+int searchWithLike(const QSqlDatabase& database, const QString& keyword) {
+    QSqlQuery query(database);
+    query.prepare("SELECT s.id, s.name, s.student_id, s.class_id, c.name AS class_name, "
+                  "(s.photo_hash IS NOT NULL) AS has_photo, s.photo_version "
+                  "FROM students s LEFT JOIN classes c ON c.id = s.class_id "
+                  "WHERE s.name LIKE :keyword OR s.student_id LIKE :keyword ORDER BY s.name");
+    query.bindValue(":keyword", "%" + keyword + "%");
+
+    // Every column is read, like the manager does for its summaries
+    int rows = 0;
+    if (query.exec()) {
+        const int columns = query.record().count();
+        while (query.next()) {
+            for (int column = 0; column < columns; column++) {
+                query.value(column);
+            }
+            rows++;
+        }
+    }
+    return rows;
+}
+
+bool runSize(int studentCount) {
+    DatabaseManager& db = DatabaseManager::instance();
+    const QString path = Bench::databasePath(QString("search-%1").arg(studentCount));
+    if (!db.initDb(path) || !Bench::populate(db, Bench::makeStudents(studentCount, CLASS_COUNT))) {
+        std::fprintf(stderr, "setup failed: %s\n", qPrintable(db.getLastError()));
+        return false;
+    }
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", LIKE_CONNECTION_NAME);
+        database.setDatabaseName(path);
+        database.open();
+
+        for (const QPair<QString, QString>& keyword : KEYWORDS) {
+            const QString label = QString("%1 rows, %2").arg(studentCount).arg(keyword.first);
+
+            int rows = 0;
+            double fts = Bench::bestOf(RUNS, [&]() {
+                rows = db.searchStudentSummariesName(keyword.second).size();
+            });
+            Bench::report(label + ", FTS5", fts, QString("%1 hits").arg(rows));
+
+            double like = Bench::bestOf(RUNS, [&]() { rows = searchWithLike(database, keyword.second); });
+            Bench::report(label + ", LIKE", like, QString("%1 hits").arg(rows));
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(LIKE_CONNECTION_NAME);
+
+    db.closeDb();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    Bench::setup("search");
+
+    for (int studentCount : {10000, 100000, 1000000}) {
+        if (!runSize(studentCount)) {
+            return 1;
+        }
+    }
+    return 0;
+}
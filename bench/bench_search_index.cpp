@@ -0,0 +1,80 @@
+// StudentSearchIndex at 100k names: build time, and find() against a plain
+// case-insensitive scan of the same rows
+#include "BenchCommon.hpp"
+#include "StudentSearchIndex.hpp"
+#include <algorithm>
+
+using namespace StudentPicker;
+
+namespace {
+
+const int STUDENT_COUNT = 100000;
+const int CLASS_COUNT = 40;
+const int RUNS = 5;
+
+// Summaries in the (name, id) order the index is built from
+QVector<StudentSummary> makeSummaries() {
+    const QVector<Student> students = Bench::makeStudents(STUDENT_COUNT, CLASS_COUNT);
+    QVector<StudentSummary> summaries;
+    summaries.reserve(students.size());
+
+    for (int i = 0; i < students.size(); i++) {
+        StudentSummary summary;
+        summary.id = i + 1;
+        summary.classId = i % CLASS_COUNT + 1;
+        summary.name = students[i].name;
+        summary.studentId = students[i].studentId;
+        summary.className = students[i].className;
+        summaries.append(summary);
+    }
+
+    std::sort(summaries.begin(), summaries.end(),
+              [](const StudentSummary& a, const StudentSummary& b) {
+                  return a.name != b.name ? a.name < b.name : a.id < b.id;
+              });
+    return summaries;
+}
+
+QVector<int> scan(const QVector<StudentSummary>& summaries, const QString& keyword, int classId) {
+    QVector<int> ids;
+    for (const StudentSummary& summary : summaries) {
+        if ((classId == -1 || summary.classId == classId) &&
+            (summary.name.contains(keyword, Qt::CaseInsensitive) ||
+             summary.studentId.contains(keyword, Qt::CaseInsensitive))) {
+            ids.append(summary.id);
+        }
+    }
+    return ids;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    Bench::setup("search-index");
+
+    const QVector<StudentSummary> summaries = makeSummaries();
+
+    StudentSearchIndex index;
+    double buildMs = Bench::bestOf(RUNS, [&]() { index.build(summaries); });
+    Bench::report("build", buildMs, QString("%1 students").arg(index.size()));
+
+    // Short keywords take the scan inside find(), longer ones the trigrams
+    const QVector<QPair<QString, int>> queries = {
+        {"bu", -1}, {"budi santoso", -1}, {"toso wija", -1}, {"S00123", -1}, {"toso wija", 7},
+    };
+
+    for (const QPair<QString, int>& query : queries) {
+        const QString label = QString("\"%1\"%2").arg(query.first)
+                                  .arg(query.second == -1 ? QString() : QString(" in class %1").arg(query.second));
+
+        int hits = 0;
+        double indexed = Bench::bestOf(RUNS, [&]() { hits = index.find(query.first, query.second).size(); });
+        Bench::report(label + ", index", indexed, QString("%1 hits").arg(hits));
+
+        double scanned = Bench::bestOf(RUNS, [&]() { hits = scan(summaries, query.first, query.second).size(); });
+        Bench::report(label + ", scan", scanned, QString("%1 hits").arg(hits));
+    }
+
+    return 0;
+}
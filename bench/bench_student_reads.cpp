@@ -0,0 +1,77 @@
+// getAllStudents on a 40k roster: one JOINed query against the old
+// pattern of one classes lookup per student row (N+1 queries)
+#include "BenchCommon.hpp"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QVariant>
+
+using namespace StudentPicker;
+
+namespace {
+
+const int STUDENT_COUNT = 40000;
+const int CLASS_COUNT = 40;
+const int RUNS = 5;
+
+// The read path before the JOIN, kept here for comparison
+QVector<Student> getAllStudentsPerRowLookup(const QSqlDatabase& database, int& queries) {
+    QVector<Student> students;
+    QSqlQuery query("SELECT * FROM students ORDER BY name", database);
+    queries++;
+
+    while (query.next()) {
+        Student student;
+        student.id = query.value("id").toInt();
+        student.name = query.value("name").toString();
+        student.studentId = query.value("student_id").toString();
+        student.classId = query.value("class_id").toInt();
+        student.photoData = query.value("photo").toByteArray();
+
+        QSqlQuery classQuery(database);
+        classQuery.prepare("SELECT name FROM classes WHERE id = :id");
+        classQuery.bindValue(":id", student.classId);
+        queries++;
+        if (classQuery.exec() && classQuery.next()) {
+            student.className = classQuery.value(0).toString();
+        }
+        students.append(student);
+    }
+    return students;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    Bench::setup("reads");
+
+    DatabaseManager& db = DatabaseManager::instance();
+    QString path = Bench::databasePath("reads");
+    if (!db.initDb(path) || !Bench::populate(db, Bench::makeStudents(STUDENT_COUNT, CLASS_COUNT))) {
+        std::fprintf(stderr, "setup failed: %s\n", qPrintable(db.getLastError()));
+        return 1;
+    }
+
+    int rows = 0;
+    double joined = Bench::bestOf(RUNS, [&]() { rows = db.getAllStudents().size(); });
+    Bench::report("getAllStudents, JOIN (1 query)", joined, QString("%1 rows").arg(rows));
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "bench-before");
+        database.setDatabaseName(path);
+        database.open();
+
+        int queries = 0;
+        double perRow = Bench::bestOf(RUNS, [&]() {
+            queries = 0;
+            rows = getAllStudentsPerRowLookup(database, queries).size();
+        });
+        Bench::report(QString("getAllStudents, per-row lookup (%1 queries)").arg(queries), perRow,
+                      QString("%1 rows").arg(rows));
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("bench-before");
+
+    db.closeDb();
+    return 0;
+}
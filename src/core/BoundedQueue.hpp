@@ -0,0 +1,75 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <QQueue>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+namespace StudentPicker {
+
+// Blocking FIFO with a fixed capacity for producer/consumer pipelines.
+// Producers block while it is full, consumers block while it is empty.
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(int capacity)
+        : m_capacity(capacity), m_closed(false), m_aborted(false) {}
+
+    // Blocks while full, returns false if the queue was aborted
+    bool push(const T& item) {
+        QMutexLocker locker(&m_mutex);
+        while (m_queue.size() >= m_capacity && !m_aborted) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_aborted) {
+            return false;
+        }
+        m_queue.enqueue(item);
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    // Blocks while empty, returns false once closed and drained or aborted
+    bool pop(T& item) {
+        QMutexLocker locker(&m_mutex);
+        while (m_queue.isEmpty() && !m_closed && !m_aborted) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        if (m_aborted || m_queue.isEmpty()) {
+            return false;
+        }
+        item = m_queue.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    // No more pushes, consumers drain what is left
+    void close() {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+    }
+
+    // Drop everything and release all waiting producers and consumers
+    void abort() {
+        QMutexLocker locker(&m_mutex);
+        m_aborted = true;
+        m_queue.clear();
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+private:
+    QQueue<T> m_queue;
+    QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    int m_capacity;
+    bool m_closed;
+    bool m_aborted;
+};
+
+} // namespace StudentPicker
+
+#endif // BOUNDEDQUEUE_HPP
@@ -1,12 +1,12 @@
 #include "CSVReader.hpp"
 #include "logger.hpp"
+#include "CSVTokenizer.hpp"
 #include <QFile>
-#include <QTextStream>
 
 namespace StudentPicker {
 
 CSVReader::CSVReader() 
-    : m_delimiter(','), m_hasHeader(true) {
+    : m_rowCount(0), m_skippedCount(0), m_delimiter(','), m_hasHeader(true) {
 }
 
 CSVReader::~CSVReader() {
@@ -14,37 +14,60 @@ CSVReader::~CSVReader() {
 
 bool CSVReader::readFile(const QString& filePath) {
     m_data.clear();
+    
+    return readFile(filePath, [this](const QVector<QVariantMap>& rows) {
+        m_data.append(rows);
+        return true;
+    });
+}
+
+bool CSVReader::readFile(const QString& filePath, const RowConsumer& consumer, int batchSize) {
     m_headers.clear();
     m_lastError.clear();
+    m_rowCount = 0;
+    m_skippedCount = 0;
     
     QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
         m_lastError = "Cannot open file: " + filePath;
         Logger::error(m_lastError);
         return false;
     }
     
-    QTextStream in(&file);
-    in.setEncoding(QStringConverter::Utf8);
+    // File di-mmap, tokenizer bekerja langsung di atas byte UTF-8 mentah
+    const qint64 fileSize = file.size();
+    const uchar* mapped = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    
+    if (fileSize > 0 && !mapped) {
+        m_lastError = "Cannot map file: " + filePath;
+        Logger::error(m_lastError);
+        return false;
+    }
+    
+    QByteArrayView bytes(reinterpret_cast<const char*>(mapped), fileSize);
+    
+    // Lewati UTF-8 BOM
+    if (bytes.startsWith("\xEF\xBB\xBF")) {
+        bytes = bytes.sliced(3);
+    }
+    
+    CSVTokenizer tokenizer(bytes, m_delimiter.toLatin1());
+    QVector<CSVField> fields;
     
     bool firstLine = true;
-    int lineNumber = 0;
     
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        lineNumber++;
-        
-        if (line.isEmpty()) {
-            continue;
-        }
-        
-        QStringList fields = parseLine(line);
-        
+    // Hanya satu batch yang ada di memory, ukuran file tidak berpengaruh
+    QVector<QVariantMap> batch;
+    batch.reserve(batchSize);
+    
+    while (tokenizer.nextRecord(fields)) {
         // First line adalah header
         if (firstLine && m_hasHeader) {
-            m_headers = fields;
+            for (const CSVField& field : fields) {
+                m_headers.append(field.toString());
+            }
             firstLine = false;
-            Logger::info("CSV Headers:", fields.join(", "));
+            Logger::info("CSV Headers:", m_headers.join(", "));
             continue;
         }
         
@@ -58,50 +81,46 @@ bool CSVReader::readFile(const QString& filePath) {
         
         // Parse data
         if (fields.size() != m_headers.size()) {
-            Logger::warn("Line", lineNumber, "has", fields.size(), 
+            Logger::warn("Line", tokenizer.lineNumber(), "has", fields.size(), 
                         "fields but expected", m_headers.size());
-            // Skip line yang tidak sesuai
+            // Skip line yang tidak sesuai, jumlahnya dilaporkan ke user
+            m_skippedCount++;
             continue;
         }
         
+        // Copy hanya terjadi di sini, saat field dijadikan QString
         QVariantMap row;
         for (int i = 0; i < m_headers.size(); i++) {
-            row[m_headers[i]] = fields[i];
+            row[m_headers[i]] = fields[i].toString();
         }
         
-        m_data.append(row);
+        batch.append(row);
+        m_rowCount++;
+        
+        if (batch.size() >= batchSize) {
+            if (!consumer(batch)) {
+                Logger::warn("CSV reading stopped by consumer at line", tokenizer.lineNumber());
+                return false;
+            }
+            batch.clear();
+        }
+    }
+    
+    if (!batch.isEmpty() && !consumer(batch)) {
+        Logger::warn("CSV reading stopped by consumer at line", tokenizer.lineNumber());
+        return false;
     }
     
     file.close();
     
     Logger::info("CSV file read successfully:", filePath);
-    Logger::info("Total rows:", m_data.size());
-    
-    return true;
-}
-
-QStringList CSVReader::parseLine(const QString& line) {
-    QStringList fields;
-    QString currentField;
-    bool inQuotes = false;
+    Logger::info("Total rows:", m_rowCount);
     
-    for (int i = 0; i < line.length(); i++) {
-        QChar c = line[i];
-        
-        if (c == '"') {
-            inQuotes = !inQuotes;
-        } else if (c == m_delimiter && !inQuotes) {
-            fields.append(currentField.trimmed());
-            currentField.clear();
-        } else {
-            currentField.append(c);
-        }
+    if (m_skippedCount > 0) {
+        Logger::warn("Skipped", m_skippedCount, "malformed rows");
     }
     
-    // Tambahkan field terakhir
-    fields.append(currentField.trimmed());
-    
-    return fields;
+    return true;
 }
 
 QVector<QVariantMap> CSVReader::getData() const {
@@ -112,6 +131,14 @@ QStringList CSVReader::getHeaders() const {
     return m_headers;
 }
 
+int CSVReader::getRowCount() const {
+    return m_rowCount;
+}
+
+int CSVReader::getSkippedCount() const {
+    return m_skippedCount;
+}
+
 QString CSVReader::getLastError() const {
     return m_lastError;
 }
@@ -4,23 +4,40 @@
 #include <QString>
 #include <QVector>
 #include <QVariantMap>
+#include <functional>
 
 namespace StudentPicker {
 
 class CSVReader {
 public:
+    // Terima satu batch baris, return false untuk berhenti membaca
+    using RowConsumer = std::function<bool(const QVector<QVariantMap>& rows)>;
+    
+    static const int DEFAULT_BATCH_SIZE = 1000;
+    
     CSVReader();
     ~CSVReader();
     
     // Baca file CSV
     bool readFile(const QString& filePath);
     
+    // Baca file CSV secara streaming, baris dikirim per batch ke consumer
+    // tanpa disimpan di m_data. Headers sudah tersedia saat batch pertama.
+    bool readFile(const QString& filePath, const RowConsumer& consumer,
+                  int batchSize = DEFAULT_BATCH_SIZE);
+    
     // Get data yang sudah dibaca
     QVector<QVariantMap> getData() const;
     
     // Get headers
     QStringList getHeaders() const;
     
+    // Jumlah baris data yang sudah dibaca
+    int getRowCount() const;
+    
+    // Jumlah baris yang dilewati karena jumlah field tidak sesuai header
+    int getSkippedCount() const;
+    
     // Get error message
     QString getLastError() const;
     
@@ -31,12 +48,11 @@ public:
     void setHasHeader(bool hasHeader);
     
 private:
-    // Parse satu baris CSV
-    QStringList parseLine(const QString& line);
-    
     QVector<QVariantMap> m_data;
     QStringList m_headers;
     QString m_lastError;
+    int m_rowCount;
+    int m_skippedCount;
     QChar m_delimiter;
     bool m_hasHeader;
 };
@@ -0,0 +1,224 @@
+#include "CSVTokenizer.hpp"
+#include <QtAlgorithms>
+
+// MSVC tidak pernah mendefinisikan __SSE2__, SSE2 selalu ada di x64 dan
+// di x86 yang dibuild dengan /arch:SSE2 ke atas
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CSV_TOKENIZER_SSE2
+#endif
+
+#if defined(__AVX2__) || defined(CSV_TOKENIZER_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace StudentPicker {
+
+namespace {
+
+// Cari byte pertama yang sama dengan delimiter, '"' atau '\n'
+inline const char* scanSpecial(const char* p, const char* end, char delimiter) {
+#if defined(__AVX2__)
+    const __m256i delim32 = _mm256_set1_epi8(delimiter);
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i newline32 = _mm256_set1_epi8('\n');
+
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, delim32), _mm256_cmpeq_epi8(chunk, quote32)),
+            _mm256_cmpeq_epi8(chunk, newline32));
+        uint mask = uint(_mm256_movemask_epi8(hits));
+        if (mask) {
+            return p + qCountTrailingZeroBits(mask);
+        }
+        p += 32;
+    }
+#endif
+
+#if defined(CSV_TOKENIZER_SSE2)
+    const __m128i delim16 = _mm_set1_epi8(delimiter);
+    const __m128i quote16 = _mm_set1_epi8('"');
+    const __m128i newline16 = _mm_set1_epi8('\n');
+
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, delim16), _mm_cmpeq_epi8(chunk, quote16)),
+            _mm_cmpeq_epi8(chunk, newline16));
+        uint mask = uint(_mm_movemask_epi8(hits));
+        if (mask) {
+            return p + qCountTrailingZeroBits(mask);
+        }
+        p += 16;
+    }
+#endif
+
+    // Scalar fallback dan sisa ekor buffer
+    while (p < end) {
+        char c = *p;
+        if (c == delimiter || c == '"' || c == '\n') {
+            return p;
+        }
+        p++;
+    }
+    return end;
+}
+
+// Tab bukan blank kalau dia delimiter, tab di awal baris berarti field kosong
+inline bool isBlank(char c, char delimiter) {
+    return c == ' ' || (c == '\t' && delimiter != '\t') || c == '\r' || c == '\n';
+}
+
+} // namespace
+
+QString CSVField::toString() const {
+    if (!quoted) {
+        return QString::fromUtf8(raw).trimmed();
+    }
+
+    if (!escaped) {
+        return QString::fromUtf8(raw);
+    }
+
+    // raw dimulai dari kutip pembuka
+    QByteArray decoded;
+    decoded.reserve(raw.size());
+
+    qsizetype i = 1;
+    while (i < raw.size()) {
+        char c = raw[i];
+        if (c == '"') {
+            if (i + 1 < raw.size() && raw[i + 1] == '"') {
+                decoded.append('"');
+                i += 2;
+                continue;
+            }
+            i++;
+            break;
+        }
+        decoded.append(c);
+        i++;
+    }
+
+    // Teks setelah kutip penutup tidak valid menurut RFC, tetap disimpan
+    if (i < raw.size()) {
+        decoded.append(raw.sliced(i).toByteArray().trimmed());
+    }
+
+    return QString::fromUtf8(decoded);
+}
+
+CSVTokenizer::CSVTokenizer(QByteArrayView data, char delimiter)
+    : m_pos(data.data()), m_end(data.data() + data.size()),
+      m_delimiter(delimiter), m_lineNumber(0) {
+}
+
+const char* CSVTokenizer::findFieldEnd(const char* p) const {
+    while (true) {
+        const char* hit = scanSpecial(p, m_end, m_delimiter);
+        if (hit == m_end || *hit != '"') {
+            return hit;
+        }
+        p = hit + 1;
+    }
+}
+
+CSVField CSVTokenizer::parseQuoted(const char* quote, const char*& fieldEnd) {
+    const char* contentStart = quote + 1;
+    const char* contentEnd = m_end;
+    const char* p = contentStart;
+    bool escaped = false;
+
+    while (true) {
+        // Di dalam kutip hanya '"' dan '\n' yang perlu diperiksa
+        const char* hit = scanSpecial(p, m_end, '"');
+
+        if (hit == m_end) {
+            // Kutip tidak ditutup sampai akhir file
+            p = m_end;
+            break;
+        }
+
+        if (*hit == '\n') {
+            m_lineNumber++;
+            p = hit + 1;
+            continue;
+        }
+
+        if (hit + 1 < m_end && hit[1] == '"') {
+            escaped = true;
+            p = hit + 2;
+            continue;
+        }
+
+        contentEnd = hit;
+        p = hit + 1;
+        break;
+    }
+
+    fieldEnd = findFieldEnd(p);
+
+    // Selain spasi, teks setelah kutip penutup butuh decode penuh
+    for (const char* c = p; c < fieldEnd; c++) {
+        if (*c != ' ' && *c != '\t' && *c != '\r') {
+            escaped = true;
+            break;
+        }
+    }
+
+    if (escaped) {
+        return CSVField(QByteArrayView(quote, fieldEnd), true, true);
+    }
+    return CSVField(QByteArrayView(contentStart, contentEnd), true, false);
+}
+
+bool CSVTokenizer::nextRecord(QVector<CSVField>& fields) {
+    fields.clear();
+
+    // Lewati baris kosong
+    while (m_pos < m_end && isBlank(*m_pos, m_delimiter)) {
+        if (*m_pos == '\n') {
+            m_lineNumber++;
+        }
+        m_pos++;
+    }
+
+    if (m_pos >= m_end) {
+        return false;
+    }
+
+    m_lineNumber++;
+
+    while (true) {
+        // Spasi sebelum kutip pembuka diabaikan
+        const char* p = m_pos;
+        while (p < m_end && (*p == ' ' || (*p == '\t' && m_delimiter != '\t'))) {
+            p++;
+        }
+
+        const char* fieldEnd;
+        if (p < m_end && *p == '"') {
+            fields.append(parseQuoted(p, fieldEnd));
+        } else {
+            fieldEnd = findFieldEnd(m_pos);
+            fields.append(CSVField(QByteArrayView(m_pos, fieldEnd), false, false));
+        }
+
+        if (fieldEnd == m_end) {
+            m_pos = m_end;
+            return true;
+        }
+
+        m_pos = fieldEnd + 1;
+
+        if (*fieldEnd == '\n') {
+            return true;
+        }
+    }
+}
+
+int CSVTokenizer::lineNumber() const {
+    return m_lineNumber;
+}
+
+} // namespace StudentPicker
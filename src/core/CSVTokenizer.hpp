@@ -0,0 +1,59 @@
+#ifndef CSVTOKENIZER_HPP
+#define CSVTOKENIZER_HPP
+
+#include <QByteArrayView>
+#include <QString>
+#include <QVector>
+
+namespace StudentPicker {
+
+// Satu field CSV sebagai view ke buffer asli (tidak ada copy).
+// Copy dan decode UTF-8 baru terjadi saat toString() dipanggil.
+//   - field biasa: raw = isi field, di-trim saat toString()
+//   - field berkutip: raw = isi di antara kutip, tidak di-trim
+//   - field berkutip dengan "" atau sisa teks setelah kutip penutup:
+//     raw = seluruh field mulai dari kutip pembuka, di-decode saat toString()
+struct CSVField {
+    QByteArrayView raw;
+    bool quoted;
+    bool escaped;
+
+    CSVField() : quoted(false), escaped(false) {}
+    CSVField(QByteArrayView raw, bool quoted, bool escaped)
+        : raw(raw), quoted(quoted), escaped(escaped) {}
+
+    QString toString() const;
+};
+
+// Tokenizer CSV (RFC 4180) di atas byte UTF-8 mentah (misalnya file yang
+// di-mmap). Field berkutip boleh berisi delimiter, newline dan "" sebagai
+// kutip literal. Delimiter, kutip dan newline dicari dengan SIMD
+// (AVX2/SSE2) dengan fallback scalar, sehingga byte biasa dilewati per
+// 16/32 byte, juga di dalam field berkutip.
+class CSVTokenizer {
+public:
+    explicit CSVTokenizer(QByteArrayView data, char delimiter = ',');
+
+    // Parse record berikutnya ke fields, return false jika data habis.
+    // Baris kosong dilewati, satu record bisa mencakup beberapa baris.
+    bool nextRecord(QVector<CSVField>& fields);
+
+    // Nomor baris terakhir yang dibaca (mulai dari 1)
+    int lineNumber() const;
+
+private:
+    // Cari delimiter atau newline berikutnya, kutip di sini dianggap teks biasa
+    const char* findFieldEnd(const char* p) const;
+
+    // Parse field berkutip mulai dari kutip pembuka di quote
+    CSVField parseQuoted(const char* quote, const char*& fieldEnd);
+
+    const char* m_pos;
+    const char* m_end;
+    char m_delimiter;
+    int m_lineNumber;
+};
+
+} // namespace StudentPicker
+
+#endif // CSVTOKENIZER_HPP
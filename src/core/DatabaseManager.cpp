@@ -1,19 +1,43 @@
 #include "DatabaseManager.hpp"
 #include "logger.hpp"
 #include "global.hpp"
+#include "userPreference.hpp"
+#include "PickBag.hpp"
+#include "StudentImporter.hpp"
+#include "ImageProcessor.hpp"
+#include "PhotoStore.hpp"
+#include "StatementCache.hpp"
 #include "qcontainerfwd.h"
 #include "qsqldatabase.h"
 #include "qsqlquery.h"
 #include <QSqlRecord>
 #include <QVariant>
+#include <QThreadPool>
+#include <QImage>
 #include <QRandomGenerator>
+#include <QStringList>
 
 
 namespace StudentPicker {
 
 const QString DatabaseManager::CONNECTION_NAME = "StudentPickerDB";
 
-DatabaseManager::DatabaseManager(){
+// Every student read goes through this projection so the class name and
+// the photo from the photo store are resolved by the same query instead of
+// extra lookups per row
+const QString DatabaseManager::STUDENT_SELECT =
+    "SELECT s.id, s.name, s.student_id, s.class_id, p.data AS photo, c.name AS class_name "
+    "FROM students s LEFT JOIN classes c ON c.id = s.class_id "
+    "LEFT JOIN photos p ON p.hash = s.photo_hash ";
+
+// Same as STUDENT_SELECT without the photo, has_photo only looks at the hash
+const QString DatabaseManager::SUMMARY_SELECT =
+    "SELECT s.id, s.name, s.student_id, s.class_id, c.name AS class_name, "
+    "(s.photo_hash IS NOT NULL) AS has_photo, s.photo_version "
+    "FROM students s LEFT JOIN classes c ON c.id = s.class_id ";
+
+DatabaseManager::DatabaseManager()
+    : m_profile(DatabaseProfile::Performance), m_hasSearchIndex(false), m_classCacheLoaded(false) {
     Logger::info("DatabaseManager has been created");
 
 }
@@ -31,6 +55,9 @@ DatabaseManager& DatabaseManager::instance(){
 bool DatabaseManager::initDb(const QString& dbPath){
     QString path = dbPath.isEmpty() ? GlobalConf::getDatabasePath() : dbPath;
 
+    // Statements of a previous connection must not outlive it
+    m_statements.reset();
+
     if ( QSqlDatabase::contains(CONNECTION_NAME) ){
         QSqlDatabase::removeDatabase(CONNECTION_NAME);
     }
@@ -45,6 +72,14 @@ bool DatabaseManager::initDb(const QString& dbPath){
     }
 
     Logger::info("Database opened successfully: ", path);
+    m_statements.reset(m_database);
+    invalidateClassCache();
+
+    m_profile = configuredProfile();
+    if (!applyProfile(m_database, m_profile)){
+        m_lastError = "Failed to apply database profile";
+        return false;
+    }
 
     if (!createTables()){
         m_lastError = "Failed to create tables";
@@ -56,7 +91,16 @@ bool DatabaseManager::initDb(const QString& dbPath){
 }
 
 void DatabaseManager::closeDb(){
+    // An unfinished import is rolled back
+    m_importer.reset();
+
     if (m_database.isOpen()){
+        // Leave a small WAL file behind, the next open does not replay it
+        checkpoint(true);
+
+        Logger::info("Statement cache:", m_statements.getHitCount(), "hits,",
+                     m_statements.getMissCount(), "misses");
+        m_statements.reset();
         m_database.close();
         Logger::info("Database has been shutdown");
     }
@@ -66,6 +110,94 @@ bool DatabaseManager::isOpen() const {
     return m_database.isOpen();
 }
 
+QSqlDatabase DatabaseManager::openWorkerConnection(const QString& connectionName) {
+    // The name based clone is safe to call from another thread
+    QSqlDatabase database = QSqlDatabase::cloneDatabase(CONNECTION_NAME, connectionName);
+
+    // Wait for the other connection instead of failing with SQLITE_BUSY
+    database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (!database.open()) {
+        Logger::error("Failed to open worker connection: ", database.lastError().text());
+    } else {
+        applyProfile(database, m_profile);
+    }
+    return database;
+}
+
+void DatabaseManager::closeWorkerConnection(const QString& connectionName) {
+    {
+        QSqlDatabase database = QSqlDatabase::database(connectionName, false);
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+void DatabaseManager::invalidateCaches() {
+    invalidatePickCache();
+    // The other connection may have added classes
+    invalidateClassCache();
+    // Bulk writes grow the WAL past the autocheckpoint in one go
+    checkpoint();
+    emit studentsReset();
+}
+
+DatabaseProfile DatabaseManager::profile() const {
+    return m_profile;
+}
+
+bool DatabaseManager::checkpoint(bool truncate) {
+    if (m_profile != DatabaseProfile::Performance || !m_database.isOpen()) {
+        return true;
+    }
+
+    QSqlQuery query(m_database);
+    if (!query.exec(truncate ? "PRAGMA wal_checkpoint(TRUNCATE)" : "PRAGMA wal_checkpoint(PASSIVE)")) {
+        m_lastError = query.lastError().text();
+        Logger::warn("WAL checkpoint failed: ", m_lastError);
+        return false;
+    }
+    return true;
+}
+
+DatabaseProfile DatabaseManager::configuredProfile() {
+    QString name = UserConfig::instance()
+        .getValue(UserConfig::KEY_DATABASE_PROFILE, "performance").toString().toLower();
+    return name == "safe" ? DatabaseProfile::Safe : DatabaseProfile::Performance;
+}
+
+bool DatabaseManager::applyProfile(QSqlDatabase& database, DatabaseProfile profile) {
+    QStringList pragmas;
+    if (profile == DatabaseProfile::Performance) {
+        // synchronous=NORMAL is durable against crashes of the app in WAL
+        // mode, only a power loss can drop the last commits
+        pragmas << "PRAGMA journal_mode = WAL"
+                << "PRAGMA synchronous = NORMAL"
+                << QString("PRAGMA cache_size = -%1").arg(GlobalConf::DB_CACHE_SIZE_KB)
+                << QString("PRAGMA mmap_size = %1").arg(GlobalConf::DB_MMAP_SIZE)
+                << "PRAGMA temp_store = MEMORY"
+                << QString("PRAGMA wal_autocheckpoint = %1").arg(GlobalConf::DB_WAL_AUTOCHECKPOINT);
+    } else {
+        pragmas << "PRAGMA journal_mode = DELETE"
+                << "PRAGMA synchronous = FULL"
+                << "PRAGMA cache_size = -2000"
+                << "PRAGMA mmap_size = 0"
+                << "PRAGMA temp_store = DEFAULT";
+    }
+
+    QSqlQuery query(database);
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            Logger::error("Failed to apply database profile: ", pragma, query.lastError().text());
+            return false;
+        }
+    }
+
+    Logger::info("Database profile applied:",
+                 profile == DatabaseProfile::Performance ? "performance" : "safe");
+    return true;
+}
+
 bool DatabaseManager::createTables(){
     QSqlQuery query(m_database);
 
@@ -102,14 +234,175 @@ bool DatabaseManager::createTables(){
             return false;
         }
 
+        if (!ensureColumn("students", "photo_version", "INTEGER NOT NULL DEFAULT 0") ||
+            !ensureColumn("students", "photo_hash", "BLOB")) {
+            return false;
+        }
+
+        // Photos are stored once per distinct image, students reference them
+        // by content hash. students.photo only remains for migrating old rows.
+        QString createPhotosTable = R"(
+            CREATE TABLE IF NOT EXISTS photos (
+                hash BLOB PRIMARY KEY,
+                data BLOB NOT NULL,
+                ref_count INTEGER NOT NULL DEFAULT 0
+                )
+            )";
+
+        if (!query.exec(createPhotosTable)){
+            m_lastError = query.lastError().text();
+            Logger::error("Failed to create photos table: ", m_lastError);
+            return false;
+        }
+
+        PhotoStore photoStore(m_database);
+        int migratedPhotos = 0;
+        if (!photoStore.migrateInlinePhotos(&migratedPhotos)) {
+            m_lastError = photoStore.getLastError();
+            return false;
+        }
+
+        // The emptied students.photo pages stay in the file until a VACUUM,
+        // needed once after the rows moved
+        if (migratedPhotos > 0 && !query.exec("VACUUM")) {
+            Logger::warn("VACUUM after the photo migration failed:", query.lastError().text());
+        }
+
         // Create indexes
         query.exec("CREATE INDEX IF NOT EXISTS idx_student_class ON students(class_id)");
         query.exec("CREATE INDEX IF NOT EXISTS idx_student_name ON students(name)");
+        // Serves the per-class pages ordered by name without a sort step
+        query.exec("CREATE INDEX IF NOT EXISTS idx_student_class_name ON students(class_id, name)");
+
+        // Shuffle bags for the no-repeat pick mode, one row per student
+        // still to be called in the current cycle of its class
+        QString createPickBagsTable = R"(
+            CREATE TABLE IF NOT EXISTS pick_bags (
+                class_id INTEGER NOT NULL,
+                slot INTEGER NOT NULL,
+                student_row_id INTEGER NOT NULL UNIQUE,
+                PRIMARY KEY (class_id, slot)
+                )
+            )";
+
+        if (!query.exec(createPickBagsTable)){
+            m_lastError = query.lastError().text();
+            Logger::error("Failed to create pick_bags table: ", m_lastError);
+            return false;
+        }
+
+        // Small pre-scaled copies of each photo, tagged with the photo_version
+        // they were made from so a replaced photo never shows a stale one
+        QString createThumbnailsTable = R"(
+            CREATE TABLE IF NOT EXISTS student_thumbnails (
+                student_row_id INTEGER PRIMARY KEY,
+                photo_version INTEGER NOT NULL,
+                display BLOB,
+                list BLOB
+                )
+            )";
+
+        if (!query.exec(createThumbnailsTable)){
+            m_lastError = query.lastError().text();
+            Logger::error("Failed to create student_thumbnails table: ", m_lastError);
+            return false;
+        }
+
+        // Optional, search falls back to LIKE without it
+        m_hasSearchIndex = createSearchIndex();
 
         Logger::info("Database tables created successfully");
         return true;
 }
 
+bool DatabaseManager::createSearchIndex() {
+    QSqlQuery query(m_database);
+
+    // Without the insert trigger the index was never filled or has missed
+    // writes while FTS5 was unavailable, either way it is rebuilt
+    query.exec("SELECT 1 FROM sqlite_master WHERE type = 'trigger' AND name = 'students_search_ai'");
+    bool needsRebuild = !query.next();
+    query.finish();
+
+    // External content table, the text stays in students and only the
+    // trigram index is stored
+    QString createSearchTable = R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS student_search USING fts5(
+            name, student_id,
+            content = 'students', content_rowid = 'id',
+            tokenize = 'trigram'
+            )
+        )";
+
+    if (!query.exec(createSearchTable)) {
+        Logger::warn("FTS5 trigram search unavailable, using LIKE: ", query.lastError().text());
+        // Triggers into a table this SQLite cannot open would break every write
+        query.exec("DROP TRIGGER IF EXISTS students_search_ai");
+        query.exec("DROP TRIGGER IF EXISTS students_search_ad");
+        query.exec("DROP TRIGGER IF EXISTS students_search_au");
+        return false;
+    }
+
+    const QStringList triggers = {
+        R"(CREATE TRIGGER IF NOT EXISTS students_search_ai AFTER INSERT ON students BEGIN
+            INSERT INTO student_search (rowid, name, student_id)
+                VALUES (new.id, new.name, new.student_id);
+        END)",
+        R"(CREATE TRIGGER IF NOT EXISTS students_search_ad AFTER DELETE ON students BEGIN
+            INSERT INTO student_search (student_search, rowid, name, student_id)
+                VALUES ('delete', old.id, old.name, old.student_id);
+        END)",
+        R"(CREATE TRIGGER IF NOT EXISTS students_search_au
+            AFTER UPDATE OF name, student_id ON students BEGIN
+            INSERT INTO student_search (student_search, rowid, name, student_id)
+                VALUES ('delete', old.id, old.name, old.student_id);
+            INSERT INTO student_search (rowid, name, student_id)
+                VALUES (new.id, new.name, new.student_id);
+        END)"
+    };
+
+    for (const QString& trigger : triggers) {
+        if (!query.exec(trigger)) {
+            Logger::warn("Failed to create search trigger: ", query.lastError().text());
+            return false;
+        }
+    }
+
+    if (needsRebuild) {
+        if (!query.exec("INSERT INTO student_search (student_search) VALUES ('rebuild')")) {
+            Logger::warn("Failed to build search index: ", query.lastError().text());
+            return false;
+        }
+        Logger::info("Student search index rebuilt");
+    }
+
+    return true;
+}
+
+bool DatabaseManager::ensureColumn(const QString& table, const QString& column, const QString& definition) {
+    QSqlQuery query(m_database);
+    if (!query.exec("PRAGMA table_info(" + table + ")")) {
+        m_lastError = query.lastError().text();
+        Logger::error("Failed to read table info:", m_lastError);
+        return false;
+    }
+
+    while (query.next()) {
+        if (query.value("name").toString() == column) {
+            return true;
+        }
+    }
+
+    if (!query.exec("ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition)) {
+        m_lastError = query.lastError().text();
+        Logger::error("Failed to add column", column, "to", table, ":", m_lastError);
+        return false;
+    }
+
+    Logger::info("Added column", column, "to", table);
+    return true;
+}
+
 bool DatabaseManager::addClass(const QString& className) {
     QSqlQuery classQuery(m_database);
     classQuery.prepare("INSERT INTO classes (name) VALUES (:name)");
@@ -122,6 +415,9 @@ bool DatabaseManager::addClass(const QString& className) {
 
     }
 
+    int classId = classQuery.lastInsertId().toInt();
+    m_classIdByName.insert(className, classId);
+
     Logger::info("Class added: ", className);
     return true;
 }
@@ -130,95 +426,302 @@ QVector<QVariantMap> DatabaseManager::getAllClasses(){
     QVector<QVariantMap> classes;
     QSqlQuery query("SELECT id, name FROM classes ORDER BY name", m_database);
 
+    // Every class is read anyway, refill the class id cache on the way
+    invalidateClassCache();
+
     while(query.next()){
+        int classId = query.value(0).toInt();
+        QString className = query.value(1).toString();
+
         QVariantMap classData;
-        classData["id"] = query.value(0).toInt();
-        classData["name"] = query.value(1).toString();
+        classData["id"] = classId;
+        classData["name"] = className;
         classes.append(classData);
+
+        m_classIdByName.insert(className, classId);
     }
+    m_classCacheLoaded = query.isActive();
     
     return classes;
 }
 
 int DatabaseManager::getClassID(const QString& className){
-    QVector<QVariantMap> classes;
-    QSqlQuery query("SELECT id, name FROM classes ORDER BY name", m_database);
-    query.bindValue(":name", className);
+    if (!m_classCacheLoaded) {
+        loadClassCache();
+    }
 
-    if (query.exec() && query.next()){
-        return query.value(0).toInt();
+    auto it = m_classIdByName.constFind(className);
+    if (it != m_classIdByName.constEnd()) {
+        return it.value();
+    }
+
+    // A loaded cache holds every class, a miss means there is none
+    if (m_classCacheLoaded) {
+        return -1;
+    }
+
+    // The cache could not be loaded, classes.name is UNIQUE so the lookup
+    // still goes through its index
+    StatementCache::Lease query = m_statements.prepare("SELECT id FROM classes WHERE name = :name");
+    query->bindValue(":name", className);
+
+    if (query->exec() && query->next()){
+        int classId = query->value(0).toInt();
+        m_classIdByName.insert(className, classId);
+        return classId;
     }
     
     return -1;
 }
 
+void DatabaseManager::loadClassCache() {
+    invalidateClassCache();
+
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT id, name FROM classes")) {
+        m_lastError = query.lastError().text();
+        Logger::error("Failed to load classes: ", m_lastError);
+        return;
+    }
+
+    while (query.next()) {
+        m_classIdByName.insert(query.value(1).toString(), query.value(0).toInt());
+    }
+    m_classCacheLoaded = true;
+}
+
+void DatabaseManager::invalidateClassCache() {
+    m_classIdByName.clear();
+    m_classCacheLoaded = false;
+}
+
 bool DatabaseManager::classExists(const QString& className){
     return getClassID(className) != -1;
 }
 
 bool DatabaseManager::addStudent(const Student& student){
-    if (!classExists(student.className)){
+    int classId = getClassID(student.className);
+    if (classId == -1){
         if(!addClass(student.className)){
             return false;
         }
-
+        classId = getClassID(student.className);
     }
 
-    int classId = getClassID(student.className);
+    StatementCache::Lease query = m_statements.prepare(
+        "INSERT INTO students (name, student_id, class_id)"
+        "VALUES (:name, :student_id, :class_id)");
+    query->bindValue(":name", student.name);
+    query->bindValue(":student_id", student.studentId);
+    query->bindValue(":class_id", classId);
 
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO students (name, student_id, class_id, photo)"
-                    "VALUES (:name, :student_id, :class_id, :photo)");
-    query.bindValue(":name", student.name);
-    query.bindValue(":student_id", student.studentId);
-    query.bindValue(":classId",classId);
-    query.bindValue(":photo", student.photoData);
-
-    if (!query.exec()){
-        m_lastError = query.lastError().text();
+    if (!query->exec()){
+        m_lastError = query->lastError().text();
         Logger::error("Failed to add student: ", m_lastError);
         return false;
 
     }
 
+    int studentRowId = query->lastInsertId().toInt();
+    m_classStudentIds.remove(classId);
+
+    if (!student.photoData.isEmpty()) {
+        PhotoStore photoStore(m_database);
+        if (photoStore.assign(studentRowId, student.photoData)) {
+            storeThumbnails(studentRowId, makeThumbnails(student.photoData));
+        } else {
+            m_lastError = photoStore.getLastError();
+        }
+    }
+
+    // Join a running no-repeat cycle of the class
+    PickBag(m_database).insert(classId, studentRowId);
+
+    emit studentsInserted({studentRowId});
+
     Logger::info("Student added: ", student.name);
     return true;
 }
 
 bool DatabaseManager::updateStudent(const Student& student){
-    QSqlQuery query(m_database);
-    query.prepare("UPDATE students SET name = :name, student_id = :student_id, "
-                    "class_id = :class_id, photo = : photo WHERE id = :id");
+    int oldClassId = -1;
+    {
+        StatementCache::Lease select = m_statements.prepare(
+            "SELECT class_id FROM students WHERE id = :id");
+        select->bindValue(":id", student.id);
+        if (select->exec() && select->next()) {
+            oldClassId = select->value(0).toInt();
+        }
+    }
 
-    query.bindValue(":name", student.name);
-    query.bindValue(":student_id", student.studentId);
-    query.bindValue(":class_id", student.classId);
-    query.bindValue(":photo", student.photoData);
-    query.bindValue(":id", student.id);
+    // The row and its photo change together or not at all
+    bool ownTransaction = m_database.transaction();
 
-    if (!query.exec()){
-        m_lastError = query.lastError().text();
+    StatementCache::Lease query = m_statements.prepare(
+        "UPDATE students SET name = :name, student_id = :student_id, "
+        "class_id = :class_id WHERE id = :id");
+
+    query->bindValue(":name", student.name);
+    query->bindValue(":student_id", student.studentId);
+    query->bindValue(":class_id", student.classId);
+    query->bindValue(":id", student.id);
+
+    if (!query->exec()){
+        m_lastError = query->lastError().text();
         Logger::error("Failed to update student: ", m_lastError);
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return false;
+    }
+
+    // photo_version only moves when the photo content actually changes,
+    // assign joins this transaction
+    PhotoStore photoStore(m_database);
+    if (!photoStore.assign(student.id, student.photoData)) {
+        m_lastError = photoStore.getLastError();
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return false;
+    }
+
+    // The student may have moved to another class
+    invalidatePickCache();
+
+    if (oldClassId != student.classId) {
+        PickBag bag(m_database);
+        if (!bag.remove(student.id) || !bag.insert(student.classId, student.id)) {
+            m_lastError = bag.getLastError();
+            if (ownTransaction) {
+                m_database.rollback();
+            }
+            return false;
+        }
+    }
+
+    // Thumbnails are only rebuilt when photo_version moved, a failure here
+    // is left to the backfill
+    if (student.photoData.isEmpty()) {
+        storeThumbnails(student.id, StudentThumbnails());
+    } else if (!hasCurrentThumbnails(student.id)) {
+        storeThumbnails(student.id, makeThumbnails(student.photoData));
     }
 
+    if (ownTransaction && !m_database.commit()) {
+        m_lastError = m_database.lastError().text();
+        Logger::error("Failed to commit student update: ", m_lastError);
+        m_database.rollback();
+        return false;
+    }
+
+    emit studentsUpdated({student.id});
+
     Logger::info("Student updated: ", student.name);
     return true;
 }
 bool DatabaseManager::deleteStudentById(int studentId) {
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM students WHERE id = :id");
-    query.bindValue(":id", studentId);
+    StatementCache::Lease query = m_statements.prepare("DELETE FROM students WHERE id = :id");
+    query->bindValue(":id", studentId);
     
-    if (!query.exec()) {
-        m_lastError = query.lastError().text();
+    // A released photo without the row delete would lose its reference
+    bool ownTransaction = m_database.transaction();
+    
+    // The photo is shared by content, drop this student's reference first
+    PhotoStore photoStore(m_database);
+    if (!photoStore.release(studentId)) {
+        m_lastError = photoStore.getLastError();
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return false;
+    }
+    
+    if (!query->exec()) {
+        m_lastError = query->lastError().text();
         Logger::error("Failed to delete student:", m_lastError);
+        if (ownTransaction) {
+            m_database.rollback();
+        }
         return false;
     }
     
+    PickBag bag(m_database);
+    if (!bag.remove(studentId)) {
+        m_lastError = bag.getLastError();
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return false;
+    }
+    
+    invalidatePickCache();
+    storeThumbnails(studentId, StudentThumbnails());
+    
+    if (ownTransaction && !m_database.commit()) {
+        m_lastError = m_database.lastError().text();
+        Logger::error("Failed to commit student delete:", m_lastError);
+        m_database.rollback();
+        return false;
+    }
+
+    emit studentsDeleted({studentId});
+
     Logger::info("Student deleted, ID:", studentId);
     return true;
 }
 
+bool DatabaseManager::updateStudentPhotos(const QVector<StudentPhotoUpdate>& photos) {
+    if (!m_database.transaction()) {
+        m_lastError = m_database.lastError().text();
+        Logger::error("Failed to start photo transaction:", m_lastError);
+        return false;
+    }
+
+    // Identical images from the batch or from other students share one row
+    PhotoStore photoStore(m_database);
+
+    for (const StudentPhotoUpdate& photo : photos) {
+        bool changed = false;
+        bool ok = photoStore.assign(photo.studentRowId, photo.photo, &changed);
+
+        if (!ok) {
+            m_lastError = photoStore.getLastError();
+        } else if (changed) {
+            ok = storeThumbnails(photo.studentRowId, photo.thumbnails.display.isEmpty()
+                                     ? makeThumbnails(photo.photo)
+                                     : photo.thumbnails);
+        }
+
+        if (!ok) {
+            Logger::error("Failed to update student photo:", m_lastError);
+            m_database.rollback();
+            return false;
+        }
+    }
+
+    if (!m_database.commit()) {
+        m_lastError = m_database.lastError().text();
+        Logger::error("Failed to commit photos:", m_lastError);
+        m_database.rollback();
+        return false;
+    }
+
+    Logger::info("Updated", photos.size(), "student photos");
+    return true;
+}
+
+QHash<QString, int> DatabaseManager::getStudentRowIdsByStudentId() {
+    QHash<QString, int> rowIds;
+    QSqlQuery query("SELECT id, student_id FROM students", m_database);
+
+    while (query.next()) {
+        rowIds.insert(query.value(1).toString(), query.value(0).toInt());
+    }
+
+    return rowIds;
+}
+
 Student DatabaseManager::resultToStudent(const QSqlQuery& query) {
     Student student;
     student.id = query.value("id").toInt();
@@ -226,25 +729,18 @@ Student DatabaseManager::resultToStudent(const QSqlQuery& query) {
     student.studentId = query.value("student_id").toString();
     student.classId = query.value("class_id").toInt();
     student.photoData = query.value("photo").toByteArray();
-    
-    // Get class name
-    QSqlQuery classQuery(m_database);
-    classQuery.prepare("SELECT name FROM classes WHERE id = :id");
-    classQuery.bindValue(":id", student.classId);
-    if (classQuery.exec() && classQuery.next()) {
-        student.className = classQuery.value(0).toString();
-    }
+    // class_name comes from the JOIN in STUDENT_SELECT, no extra lookup per row
+    student.className = query.value("class_name").toString();
     
     return student;
 }
 
 Student DatabaseManager::getStudentId(int studentId) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM students WHERE id = :id");
-    query.bindValue(":id", studentId);
+    StatementCache::Lease query = m_statements.prepare(STUDENT_SELECT + "WHERE s.id = :id");
+    query->bindValue(":id", studentId);
     
-    if (query.exec() && query.next()) {
-        return resultToStudent(query);
+    if (query->exec() && query->next()) {
+        return resultToStudent(*query);
     }
     
     return Student();
@@ -252,7 +748,7 @@ Student DatabaseManager::getStudentId(int studentId) {
 
 QVector<Student> DatabaseManager::getAllStudents() {
     QVector<Student> students;
-    QSqlQuery query("SELECT * FROM students ORDER BY name", m_database);
+    QSqlQuery query(STUDENT_SELECT + "ORDER BY s.name, s.id", m_database);
     
     while (query.next()) {
         students.append(resultToStudent(query));
@@ -263,13 +759,13 @@ QVector<Student> DatabaseManager::getAllStudents() {
 
 QVector<Student> DatabaseManager::getStudentsByClassId(int classId) {
     QVector<Student> students;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM students WHERE class_id = :class_id ORDER BY name");
-    query.bindValue(":class_id", classId);
+    StatementCache::Lease query = m_statements.prepare(
+        STUDENT_SELECT + "WHERE s.class_id = :class_id ORDER BY s.name, s.id");
+    query->bindValue(":class_id", classId);
     
-    if (query.exec()) {
-        while (query.next()) {
-            students.append(resultToStudent(query));
+    if (query->exec()) {
+        while (query->next()) {
+            students.append(resultToStudent(*query));
         }
     }
     
@@ -284,30 +780,365 @@ QVector<Student> DatabaseManager::getStudentsByClassName(const QString& classNam
     return getStudentsByClassId(classId);
 }
 
+QString DatabaseManager::searchFilter(const QString& keyword) const {
+    // The trigram index can only answer substrings of 3+ characters. FTS5
+    // counts code points, size() would count a surrogate pair twice.
+    if (m_hasSearchIndex && keyword.toUcs4().size() >= 3) {
+        return "WHERE s.id IN (SELECT rowid FROM student_search "
+               "WHERE student_search MATCH :keyword) ";
+    }
+    return "WHERE s.name LIKE :keyword OR s.student_id LIKE :keyword ";
+}
+
+QString DatabaseManager::searchValue(const QString& keyword) const {
+    if (m_hasSearchIndex && keyword.toUcs4().size() >= 3) {
+        // One quoted phrase, FTS5 query syntax in the keyword stays literal
+        return "\"" + QString(keyword).replace("\"", "\"\"") + "\"";
+    }
+    return "%" + keyword + "%";
+}
+
 QVector<Student> DatabaseManager::searchStudentsName(const QString& keyword) {
     QVector<Student> students;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM students WHERE name LIKE :keyword OR student_id LIKE :keyword");
-    query.bindValue(":keyword", "%" + keyword + "%");
+    StatementCache::Lease query = m_statements.prepare(
+        STUDENT_SELECT + searchFilter(keyword) + "ORDER BY s.name, s.id");
+    query->bindValue(":keyword", searchValue(keyword));
     
-    if (query.exec()) {
-        while (query.next()) {
-            students.append(resultToStudent(query));
+    if (query->exec()) {
+        while (query->next()) {
+            students.append(resultToStudent(*query));
         }
     }
     
     return students;
 }
 
+StudentSummary DatabaseManager::resultToSummary(const QSqlQuery& query) {
+    StudentSummary summary;
+    summary.id = query.value("id").toInt();
+    summary.name = query.value("name").toString();
+    summary.studentId = query.value("student_id").toString();
+    summary.classId = query.value("class_id").toInt();
+    summary.className = query.value("class_name").toString();
+    summary.hasPhoto = query.value("has_photo").toBool();
+    summary.photoVersion = query.value("photo_version").toInt();
+
+    return summary;
+}
+
+StudentSummary DatabaseManager::getStudentSummaryId(int studentId) {
+    StatementCache::Lease query = m_statements.prepare(SUMMARY_SELECT + "WHERE s.id = :id");
+    query->bindValue(":id", studentId);
+
+    if (query->exec() && query->next()) {
+        return resultToSummary(*query);
+    }
+
+    return StudentSummary();
+}
+
+QVector<StudentSummary> DatabaseManager::getAllStudentSummaries() {
+    QVector<StudentSummary> students;
+    // Same (name, id) order as the paged list, equal names keep their rows
+    QSqlQuery query(SUMMARY_SELECT + "ORDER BY s.name, s.id", m_database);
+
+    while (query.next()) {
+        students.append(resultToSummary(query));
+    }
+
+    return students;
+}
+
+QVector<StudentSummary> DatabaseManager::getStudentSummariesByClassId(int classId) {
+    QVector<StudentSummary> students;
+    StatementCache::Lease query = m_statements.prepare(
+        SUMMARY_SELECT + "WHERE s.class_id = :class_id ORDER BY s.name, s.id");
+    query->bindValue(":class_id", classId);
+
+    if (query->exec()) {
+        while (query->next()) {
+            students.append(resultToSummary(*query));
+        }
+    }
+
+    return students;
+}
+
+QVector<StudentSummary> DatabaseManager::getStudentSummariesByClassName(const QString& className) {
+    int classId = getClassID(className);
+    if (classId == -1) {
+        return QVector<StudentSummary>();
+    }
+    return getStudentSummariesByClassId(classId);
+}
+
+QVector<StudentSummary> DatabaseManager::searchStudentSummariesName(const QString& keyword) {
+    QVector<StudentSummary> students;
+    StatementCache::Lease query = m_statements.prepare(
+        SUMMARY_SELECT + searchFilter(keyword) + "ORDER BY s.name, s.id");
+    query->bindValue(":keyword", searchValue(keyword));
+
+    if (query->exec()) {
+        while (query->next()) {
+            students.append(resultToSummary(*query));
+        }
+    }
+
+    return students;
+}
+
+QVector<StudentSummary> DatabaseManager::getStudentSummariesPage(int classId, int offset, int limit) {
+    QString filter = classId == -1 ? QString() : "WHERE s.class_id = :class_id ";
+
+    StatementCache::Lease query = m_statements.prepare(
+        SUMMARY_SELECT + filter + "ORDER BY s.name, s.id LIMIT :limit OFFSET :offset");
+    if (classId != -1) {
+        query->bindValue(":class_id", classId);
+    }
+    query->bindValue(":limit", limit);
+    query->bindValue(":offset", offset);
+
+    return fetchSummaries(*query);
+}
+
+QVector<StudentSummary> DatabaseManager::getStudentSummariesAfter(int classId, const QString& name,
+                                                                  int id, int limit) {
+    // Row value comparison matches the (name, id) order of the index
+    QString filter = classId == -1 ? QString("WHERE ") : "WHERE s.class_id = :class_id AND ";
+
+    StatementCache::Lease query = m_statements.prepare(
+        SUMMARY_SELECT + filter +
+        "(s.name, s.id) > (:name, :id) ORDER BY s.name, s.id LIMIT :limit");
+    if (classId != -1) {
+        query->bindValue(":class_id", classId);
+    }
+    query->bindValue(":name", name);
+    query->bindValue(":id", id);
+    query->bindValue(":limit", limit);
+
+    return fetchSummaries(*query);
+}
+
+QVector<StudentSummary> DatabaseManager::getStudentSummariesByIds(const QVector<int>& ids) {
+    QVector<StudentSummary> students(ids.size());
+    if (ids.isEmpty()) {
+        return students;
+    }
+
+    // Integers only, safe to inline. Not cached, the list changes every call.
+    QStringList idList;
+    QHash<int, int> positions;
+    for (int i = 0; i < ids.size(); i++) {
+        idList << QString::number(ids[i]);
+        positions.insert(ids[i], i);
+    }
+
+    QSqlQuery query(m_database);
+    if (!query.exec(SUMMARY_SELECT + "WHERE s.id IN (" + idList.join(',') + ")")) {
+        m_lastError = query.lastError().text();
+        Logger::error("Failed to fetch students:", m_lastError);
+        return students;
+    }
+
+    while (query.next()) {
+        StudentSummary summary = resultToSummary(query);
+        students[positions.value(summary.id)] = summary;
+    }
+
+    return students;
+}
+
+QVector<StudentSummary> DatabaseManager::fetchSummaries(QSqlQuery& query) {
+    QVector<StudentSummary> students;
+
+    if (!query.exec()) {
+        m_lastError = query.lastError().text();
+        Logger::error("Failed to fetch students:", m_lastError);
+        return students;
+    }
+
+    while (query.next()) {
+        students.append(resultToSummary(query));
+    }
+
+    return students;
+}
+
+QByteArray DatabaseManager::getStudentPhoto(int studentId) {
+    StatementCache::Lease query = m_statements.prepare(
+        "SELECT p.data FROM students s JOIN photos p ON p.hash = s.photo_hash "
+        "WHERE s.id = :id");
+    query->bindValue(":id", studentId);
+
+    if (query->exec() && query->next()) {
+        return query->value(0).toByteArray();
+    }
+
+    return QByteArray();
+}
+
+QByteArray DatabaseManager::getStudentThumbnail(int studentId, int photoVersion, ThumbnailKind kind) {
+    QString column = kind == ThumbnailKind::Display ? "display" : "list";
+
+    StatementCache::Lease query = m_statements.prepare(
+        "SELECT " + column + " FROM student_thumbnails "
+        "WHERE student_row_id = :id AND photo_version = :photo_version");
+    query->bindValue(":id", studentId);
+    query->bindValue(":photo_version", photoVersion);
+
+    if (query->exec() && query->next()) {
+        return query->value(0).toByteArray();
+    }
+
+    return QByteArray();
+}
+
+int DatabaseManager::backfillThumbnails(int afterId, int limit) {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT s.id, p.data FROM students s "
+                  "JOIN photos p ON p.hash = s.photo_hash "
+                  "LEFT JOIN student_thumbnails t ON t.student_row_id = s.id "
+                  "WHERE s.id > :after_id "
+                  "AND (t.student_row_id IS NULL OR t.photo_version <> s.photo_version) "
+                  "ORDER BY s.id LIMIT :limit");
+    query.bindValue(":after_id", afterId);
+    query.bindValue(":limit", limit);
+
+    if (!query.exec()) {
+        m_lastError = query.lastError().text();
+        Logger::error("Failed to read photos for thumbnails:", m_lastError);
+        return -1;
+    }
+
+    QVector<int> rowIds;
+    QVector<QByteArray> photos;
+    while (query.next()) {
+        rowIds.append(query.value(0).toInt());
+        photos.append(query.value(1).toByteArray());
+    }
+    query.finish();
+
+    if (rowIds.isEmpty()) {
+        return -1;
+    }
+
+    // Decoding dominates, spread it over the cores
+    QVector<StudentThumbnails> thumbnails(rowIds.size());
+    QThreadPool pool;
+    for (int i = 0; i < rowIds.size(); i++) {
+        pool.start([&thumbnails, &photos, i]() {
+            thumbnails[i] = makeThumbnails(photos[i]);
+        });
+    }
+    pool.waitForDone();
+
+    bool ownTransaction = m_database.transaction();
+    for (int i = 0; i < rowIds.size(); i++) {
+        if (!storeThumbnails(rowIds[i], thumbnails[i])) {
+            // storeThumbnails logged it, the next start tries the batch again
+            if (ownTransaction) {
+                m_database.rollback();
+            }
+            return -1;
+        }
+    }
+    if (ownTransaction && !m_database.commit()) {
+        m_lastError = m_database.lastError().text();
+        Logger::error("Failed to commit thumbnails:", m_lastError);
+        m_database.rollback();
+        return -1;
+    }
+
+    Logger::info("Generated thumbnails for", rowIds.size(), "photos");
+    return rowIds.last();
+}
+
+StudentThumbnails DatabaseManager::makeThumbnails(const QByteArray& photo) {
+    StudentThumbnails thumbnails;
+
+    // One scaled decode serves both sizes
+    QImage image = ImageProcessor::imageFromData(photo,
+                                                 GlobalConf::DISPLAY_IMAGE_WIDTH,
+                                                 GlobalConf::DISPLAY_IMAGE_HEIGHT);
+    if (image.isNull()) {
+        return thumbnails;
+    }
+
+    thumbnails.display = ImageProcessor::encodeThumbnail(
+        image, GlobalConf::DISPLAY_IMAGE_WIDTH, GlobalConf::DISPLAY_IMAGE_HEIGHT);
+    thumbnails.list = ImageProcessor::encodeThumbnail(
+        image, GlobalConf::LIST_THUMBNAIL_SIZE, GlobalConf::LIST_THUMBNAIL_SIZE);
+
+    return thumbnails;
+}
+
+bool DatabaseManager::storeThumbnails(int studentRowId, const StudentThumbnails& thumbnails) {
+    // Tagged with the version of the photo row as it is now
+    StatementCache::Lease query = m_statements.prepare(thumbnails.display.isEmpty()
+        ? "DELETE FROM student_thumbnails WHERE student_row_id = :id"
+        : "INSERT OR REPLACE INTO student_thumbnails "
+          "(student_row_id, photo_version, display, list) "
+          "SELECT id, photo_version, :display, :list FROM students WHERE id = :id");
+
+    if (!thumbnails.display.isEmpty()) {
+        query->bindValue(":display", thumbnails.display);
+        query->bindValue(":list", thumbnails.list);
+    }
+    query->bindValue(":id", studentRowId);
+
+    if (!query->exec()) {
+        m_lastError = query->lastError().text();
+        Logger::error("Failed to store thumbnails:", m_lastError);
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::hasCurrentThumbnails(int studentRowId) {
+    StatementCache::Lease query = m_statements.prepare(
+        "SELECT 1 FROM student_thumbnails t "
+        "JOIN students s ON s.id = t.student_row_id "
+        "WHERE t.student_row_id = :id AND t.photo_version = s.photo_version");
+    query->bindValue(":id", studentRowId);
+
+    return query->exec() && query->next();
+}
+
+QVector<int> DatabaseManager::studentIdsForClass(int classId) {
+    auto it = m_classStudentIds.constFind(classId);
+    if (it != m_classStudentIds.constEnd()) {
+        return it.value();
+    }
+
+    // Only the row ids are read, the class is loaded once until it changes
+    QVector<int> ids;
+    StatementCache::Lease query = m_statements.prepare(
+        "SELECT id FROM students WHERE class_id = :class_id");
+    query->bindValue(":class_id", classId);
+
+    if (query->exec()) {
+        while (query->next()) {
+            ids.append(query->value(0).toInt());
+        }
+    }
+
+    m_classStudentIds.insert(classId, ids);
+    return ids;
+}
+
+void DatabaseManager::invalidatePickCache() {
+    m_classStudentIds.clear();
+}
+
 Student DatabaseManager::getRandomStudentClassId(int classId) {
-    QVector<Student> students = getStudentsByClassId(classId);
+    const QVector<int> ids = studentIdsForClass(classId);
     
-    if (students.isEmpty()) {
+    if (ids.isEmpty()) {
         return Student();
     }
     
-    int randomIndex = QRandomGenerator::global()->bounded(students.size());
-    return students[randomIndex];
+    int randomIndex = QRandomGenerator::global()->bounded(ids.size());
+    return getStudentId(ids[randomIndex]);
 }
 
 Student DatabaseManager::getRandomStudentClassName(const QString& className) {
@@ -318,6 +1149,33 @@ Student DatabaseManager::getRandomStudentClassName(const QString& className) {
     return getRandomStudentClassId(classId);
 }
 
+Student DatabaseManager::getFairStudentClassId(int classId) {
+    PickBag bag(m_database);
+    int studentRowId = bag.pop(classId);
+
+    // Cycle finished, everyone has been called once
+    if (studentRowId == -1) {
+        if (!bag.refill(classId, studentIdsForClass(classId))) {
+            m_lastError = bag.getLastError();
+            return Student();
+        }
+        studentRowId = bag.pop(classId);
+    }
+
+    if (studentRowId == -1) {
+        return Student();
+    }
+    return getStudentId(studentRowId);
+}
+
+Student DatabaseManager::getFairStudentClassName(const QString& className) {
+    int classId = getClassID(className);
+    if (classId == -1) {
+        return Student();
+    }
+    return getFairStudentClassId(classId);
+}
+
 int DatabaseManager::countStudents() {
     QSqlQuery query("SELECT COUNT(*) FROM students", m_database);
     if (query.exec() && query.next()) {
@@ -327,54 +1185,153 @@ int DatabaseManager::countStudents() {
 }
 
 int DatabaseManager::countStudentsByClass(int classId) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT COUNT(*) FROM students WHERE class_id = :class_id");
-    query.bindValue(":class_id", classId);
+    StatementCache::Lease query = m_statements.prepare(
+        "SELECT COUNT(*) FROM students WHERE class_id = :class_id");
+    query->bindValue(":class_id", classId);
     
-    if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+    if (query->exec() && query->next()) {
+        return query->value(0).toInt();
     }
     return 0;
 }
 
+int DatabaseManager::studentPosition(int classId, const StudentSummary& student) {
+    if (student.id == -1 || (classId != -1 && student.classId != classId)) {
+        return -1;
+    }
+
+    // Counts the index range in front of the student
+    QString filter = classId == -1 ? QString("WHERE ") : "WHERE class_id = :class_id AND ";
+
+    StatementCache::Lease query = m_statements.prepare(
+        "SELECT COUNT(*) FROM students " + filter + "(name, id) < (:name, :id)");
+    if (classId != -1) {
+        query->bindValue(":class_id", classId);
+    }
+    query->bindValue(":name", student.name);
+    query->bindValue(":id", student.id);
+
+    if (query->exec() && query->next()) {
+        return query->value(0).toInt();
+    }
+    return -1;
+}
+
 // ==== BATCH OPERATIONS ====
 
 bool DatabaseManager::importStudentsFile(const QVector<Student>& students) {
-    // Start transaction
-    m_database.transaction();
-    
-    bool success = true;
-    for (const Student& student : students) {
-        if (!addStudent(student)) {
-            success = false;
-            break;
-        }
+    bool success = beginImport() && importStudentsBatch(students);
+    return finishImport(success) && success;
+}
+
+bool DatabaseManager::beginImport() {
+    // One transaction, one prepared INSERT and one class lookup per import
+    m_importer = std::make_unique<StudentImporter>(m_database);
+    
+    if (!m_importer->begin()) {
+        m_lastError = m_importer->getLastError();
+        m_importer.reset();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::importStudentsBatch(const QVector<Student>& students) {
+    if (!m_importer) {
+        m_lastError = "No import in progress";
+        return false;
+    }
+    
+    if (!m_importer->addBatch(students)) {
+        m_lastError = m_importer->getLastError();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::finishImport(bool commit) {
+    if (!m_importer) {
+        return false;
     }
     
+    bool success = commit && m_importer->commit();
+    
     if (success) {
-        m_database.commit();
-        Logger::info("Successfully imported", students.size(), "students");
+        Logger::info("Successfully imported", m_importer->importedCount(), "students");
     } else {
-        m_database.rollback();
+        m_importer->rollback();
+        if (commit) {
+            m_lastError = m_importer->getLastError();
+        }
         Logger::error("Failed to import students, transaction rolled back");
     }
     
+    m_importer.reset();
+    invalidatePickCache();
+    // The importer adds classes through its own statements
+    invalidateClassCache();
+
+    if (success) {
+        checkpoint();
+        emit studentsReset();
+    }
     return success;
 }
 
 bool DatabaseManager::clearAllStudents() {
-    QSqlQuery query("DELETE FROM students", m_database);
+    // Students, bags, photos and thumbnails go together or not at all
+    bool ownTransaction = m_database.transaction();
     
-    if (!query.exec()) {
+    QSqlQuery query(m_database);
+    PickBag bag(m_database);
+    PhotoStore photoStore(m_database);
+    
+    bool success = query.exec("DELETE FROM students");
+    if (!success) {
+        m_lastError = query.lastError().text();
+    } else if (!bag.clear()) {
+        m_lastError = bag.getLastError();
+        success = false;
+    } else if (!photoStore.clear()) {
+        m_lastError = photoStore.getLastError();
+        success = false;
+    } else if (!query.exec("DELETE FROM student_thumbnails")) {
         m_lastError = query.lastError().text();
+        success = false;
+    }
+    
+    if (!success) {
         Logger::error("Failed to clear students:", m_lastError);
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return false;
+    }
+    
+    if (ownTransaction && !m_database.commit()) {
+        m_lastError = m_database.lastError().text();
+        Logger::error("Failed to commit clearing students:", m_lastError);
+        m_database.rollback();
         return false;
     }
     
+    invalidatePickCache();
+    invalidateClassCache();
+
+    emit studentsReset();
+
     Logger::warn("All students cleared from database");
     return true;
 }
 
+quint64 DatabaseManager::getStatementCacheHits() const {
+    return m_statements.getHitCount();
+}
+
+quint64 DatabaseManager::getStatementCacheMisses() const {
+    return m_statements.getMissCount();
+}
+
 QString DatabaseManager::getLastError() const {
     return m_lastError;
 }
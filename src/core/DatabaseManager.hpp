@@ -8,11 +8,48 @@
 #include <QSqlError>
 #include <QString>
 #include <QVector>
+#include <QHash>
+#include <QPair>
 #include <QVariantMap>
 #include <QByteArray>
+#include <QObject>
+#include <memory>
+#include "StatementCache.hpp"
 
 namespace StudentPicker{
 
+class StudentImporter;
+
+// Pre-scaled JPEG copies of a photo, kept in student_thumbnails so the
+// display path never decodes and rescales the full photo
+struct StudentThumbnails {
+    QByteArray display;     // fits DISPLAY_IMAGE_WIDTH x DISPLAY_IMAGE_HEIGHT
+    QByteArray list;        // fits LIST_THUMBNAIL_SIZE square
+};
+
+enum class ThumbnailKind {
+    Display,
+    List
+};
+
+struct StudentPhotoUpdate {
+    int studentRowId;
+    QByteArray photo;
+    // Generated from photo when left empty
+    StudentThumbnails thumbnails;
+
+    StudentPhotoUpdate() : studentRowId(-1) {}
+};
+
+// SQLite settings applied to every connection, chosen through
+// UserConfig::KEY_DATABASE_PROFILE ("performance" or "safe")
+enum class DatabaseProfile {
+    // WAL, synchronous=NORMAL, mmap, larger page cache, in-memory temp store
+    Performance,
+    // Rollback journal with synchronous=FULL, the SQLite defaults
+    Safe
+};
+
 struct Student {
     int id;
     int classId;
@@ -24,7 +61,23 @@ struct Student {
     Student() : id(-1), classId(-1) {}
 };
 
-class DatabaseManager {
+// Lightweight student row for list views, the photo BLOB is never loaded
+struct StudentSummary {
+    int id;
+    int classId;
+    QString name;
+    QString studentId;
+    QString className;
+    bool hasPhoto;
+    // Bumped on every photo change, part of the thumbnail cache key
+    int photoVersion;
+
+    StudentSummary() : id(-1), classId(-1), hasPhoto(false), photoVersion(0) {}
+};
+
+class DatabaseManager : public QObject {
+    Q_OBJECT
+
 public:
 
     // Singleton pattern
@@ -43,6 +96,20 @@ public:
     // Check if the Db is still open
     bool isOpen() const;
 
+    // Open a separate connection to the same database for a worker thread,
+    // call from that thread and close it there when done
+    QSqlDatabase openWorkerConnection(const QString& connectionName);
+    static void closeWorkerConnection(const QString& connectionName);
+
+    // Drop cached data after rows were written through another connection
+    void invalidateCaches();
+
+    DatabaseProfile profile() const;
+
+    // Move committed WAL frames back into the database file. PASSIVE never
+    // waits for readers, TRUNCATE also resets the WAL file.
+    bool checkpoint(bool truncate = false);
+
     // CRUD operation for classes
 
     // Add new class table
@@ -51,7 +118,8 @@ public:
     // Fetch all classes in the database
     QVector<QVariantMap> getAllClasses();
 
-    // Get class ID by name
+    // Class id by name, answered from a cache of the classes table loaded
+    // on first use. -1 if there is no such class.
     int getClassID(const QString& className);
 
     // Check for existing class
@@ -63,6 +131,13 @@ public:
 
     bool deleteStudentById(int studentId);
 
+    // Replace the photos and thumbnails of many students in one
+    // transaction. Bulk write, callers report it through invalidateCaches
+    bool updateStudentPhotos(const QVector<StudentPhotoUpdate>& photos);
+
+    // StudentID -> row id of every student
+    QHash<QString, int> getStudentRowIdsByStudentId();
+
     Student getStudentId(int studentId);
 
     QVector<Student> getAllStudents();
@@ -71,23 +146,79 @@ public:
 
     QVector<Student> getStudentsByClassName(const QString& className);
 
-    // Search students name
+    // Substring search over name and StudentID, served by the FTS5 trigram
+    // index when SQLite has it and by a LIKE scan otherwise
     QVector<Student> searchStudentsName(const QString& keyword);
 
+    // Photo-less reads for list views, use getStudentPhoto for the image
+    StudentSummary getStudentSummaryId(int studentId);
+    QVector<StudentSummary> getAllStudentSummaries();
+    QVector<StudentSummary> getStudentSummariesByClassId(int classId);
+    QVector<StudentSummary> getStudentSummariesByClassName(const QString& className);
+    QVector<StudentSummary> searchStudentSummariesName(const QString& keyword);
+
+    // One page of summaries ordered by (name, id), classId -1 = all classes.
+    // The After variant seeks past the last row of the previous page through
+    // the index instead of stepping over an OFFSET.
+    QVector<StudentSummary> getStudentSummariesPage(int classId, int offset, int limit);
+    QVector<StudentSummary> getStudentSummariesAfter(int classId, const QString& name,
+                                                     int id, int limit);
+
+    // Summaries in the order of ids, a missing student leaves an invalid one
+    QVector<StudentSummary> getStudentSummariesByIds(const QVector<int>& ids);
+
+    // Fetch only the photo BLOB of a student
+    QByteArray getStudentPhoto(int studentId);
+
+    // Stored thumbnail of the given photo version, empty if missing or stale
+    QByteArray getStudentThumbnail(int studentId, int photoVersion, ThumbnailKind kind);
+
+    // Generate missing or stale thumbnails for up to limit photos with a row
+    // id above afterId. Returns the last row id handled, -1 when none remain
+    // or the batch could not be stored.
+    static const int THUMBNAIL_BACKFILL_BATCH = 50;
+    int backfillThumbnails(int afterId, int limit = THUMBNAIL_BACKFILL_BATCH);
+
     // Pick random student from class
     Student getRandomStudentClassId(int classId);
     Student getRandomStudentClassName(const QString& className);
 
+    // Pick without repeats, everyone in the class is called once per cycle
+    Student getFairStudentClassId(int classId);
+    Student getFairStudentClassName(const QString& className);
+
     // Count student
     int countStudents();
     int countStudentsByClass(int classId);
 
+    // Row index of a student in the (name, id) order of a class (-1 = all
+    // classes), -1 if the student is not in that list
+    int studentPosition(int classId, const StudentSummary& student);
+
     bool importStudentsFile(const QVector<Student>& students);
 
+    // Streaming import session, rows arrive in batches between
+    // beginImport and finishImport inside one transaction
+    bool beginImport();
+    bool importStudentsBatch(const QVector<Student>& students);
+    bool finishImport(bool commit = true);
+
     bool clearAllStudents();
 
+    // Reuse of prepared statements on the main connection since initDb
+    quint64 getStatementCacheHits() const;
+    quint64 getStatementCacheMisses() const;
+
     QString getLastError() const;
 
+signals:
+    // Emitted on the database thread after a successful write, connect with
+    // a queued/auto connection. Bulk writes only report studentsReset.
+    void studentsInserted(const QVector<int>& ids);
+    void studentsUpdated(const QVector<int>& ids);
+    void studentsDeleted(const QVector<int>& ids);
+    void studentsReset();
+
 private:
     DatabaseManager();
     ~DatabaseManager();
@@ -95,11 +226,53 @@ private:
     // Create students database table
     bool createTables();
 
+    // Profile from UserConfig, unknown values fall back to Performance
+    static DatabaseProfile configuredProfile();
+
+    // Per connection pragmas, journal_mode is also stored in the file
+    static bool applyProfile(QSqlDatabase& database, DatabaseProfile profile);
+
+    // student_search FTS5 table and its sync triggers, false if unavailable
+    bool createSearchIndex();
+
+    // WHERE clause and :keyword value of a name/StudentID search
+    QString searchFilter(const QString& keyword) const;
+    QString searchValue(const QString& keyword) const;
+
+    // Add a column to a table created by an older version
+    bool ensureColumn(const QString& table, const QString& column, const QString& definition);
+
+    // Thumbnails for the current photo_version of a student
+    static StudentThumbnails makeThumbnails(const QByteArray& photo);
+    bool storeThumbnails(int studentRowId, const StudentThumbnails& thumbnails);
+    bool hasCurrentThumbnails(int studentRowId);
+
     Student resultToStudent(const QSqlQuery& s_query);
+    StudentSummary resultToSummary(const QSqlQuery& s_query);
+    QVector<StudentSummary> fetchSummaries(QSqlQuery& query);
+
+    // Cached student row ids of a class for the random pick
+    QVector<int> studentIdsForClass(int classId);
+    void invalidatePickCache();
+
+    // Name <-> id of every class. Kept current by addClass, dropped when
+    // classes may have been written through another path.
+    void loadClassCache();
+    void invalidateClassCache();
 
     QSqlDatabase m_database;
+    // Declared after m_database so the statements go first
+    StatementCache m_statements;
+    DatabaseProfile m_profile;
+    bool m_hasSearchIndex;
     QString m_lastError;
+    QHash<int, QVector<int>> m_classStudentIds;
+    QHash<QString, int> m_classIdByName;
+    bool m_classCacheLoaded;
+    std::unique_ptr<StudentImporter> m_importer;
     static const QString CONNECTION_NAME;
+    static const QString STUDENT_SELECT;
+    static const QString SUMMARY_SELECT;
 };
 }
 
@@ -0,0 +1,44 @@
+#include "DatabaseWorker.hpp"
+#include "logger.hpp"
+
+namespace StudentPicker {
+
+DatabaseWorker::DatabaseWorker()
+    : m_context(new QObject()) {
+    m_thread.setObjectName("DatabaseWorker");
+    m_context->moveToThread(&m_thread);
+}
+
+DatabaseWorker::~DatabaseWorker() {
+    stop();
+    delete m_context;
+}
+
+DatabaseWorker& DatabaseWorker::instance() {
+    static DatabaseWorker instance;
+    return instance;
+}
+
+void DatabaseWorker::start() {
+    if (m_thread.isRunning()) {
+        return;
+    }
+
+    m_thread.start();
+    Logger::info("Database worker thread started");
+}
+
+void DatabaseWorker::stop() {
+    if (!m_thread.isRunning()) {
+        return;
+    }
+
+    // The connection belongs to the worker thread, close it there
+    runSync([](DatabaseManager& db) { db.closeDb(); });
+
+    m_thread.quit();
+    m_thread.wait();
+    Logger::info("Database worker thread stopped");
+}
+
+} // namespace StudentPicker
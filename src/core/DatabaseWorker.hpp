@@ -0,0 +1,78 @@
+#ifndef DATABASEWORKER_HPP
+#define DATABASEWORKER_HPP
+
+#include <QThread>
+#include <QObject>
+#include <QFuture>
+#include <QPromise>
+#include <memory>
+#include <type_traits>
+#include "DatabaseManager.hpp"
+
+namespace StudentPicker {
+
+// Dedicated database thread. The DatabaseManager connection is opened on
+// this thread and every call to it is queued here, so the GUI thread never
+// waits on SQLite. Jobs run one at a time in submission order.
+class DatabaseWorker {
+public:
+    static DatabaseWorker& instance();
+
+    // Delete copy constructor and assignment operator
+    DatabaseWorker(const DatabaseWorker&) = delete;
+    DatabaseWorker& operator=(const DatabaseWorker&) = delete;
+
+    // Start the thread, must happen before the first run()
+    void start();
+
+    // Close the database on its own thread and join the thread
+    void stop();
+
+    // Queue a DatabaseManager job, the result arrives through the future.
+    // Use QFuture::then(context, ...) to get back onto the GUI thread.
+    template<typename Job>
+    auto run(Job job) -> QFuture<std::invoke_result_t<Job, DatabaseManager&>> {
+        using Result = std::invoke_result_t<Job, DatabaseManager&>;
+
+        auto promise = std::make_shared<QPromise<Result>>();
+        QFuture<Result> future = promise->future();
+        promise->start();
+
+        QMetaObject::invokeMethod(m_context, [promise, job]() mutable {
+            if constexpr (std::is_void_v<Result>) {
+                job(DatabaseManager::instance());
+            } else {
+                promise->addResult(job(DatabaseManager::instance()));
+            }
+            promise->finish();
+        }, Qt::QueuedConnection);
+
+        return future;
+    }
+
+    // Queue a job and wait for it, only for calls that are known to be short
+    template<typename Job>
+    auto runSync(Job job) -> std::invoke_result_t<Job, DatabaseManager&> {
+        if (QThread::currentThread() == &m_thread) {
+            return job(DatabaseManager::instance());
+        }
+
+        auto future = run(job);
+        if constexpr (std::is_void_v<std::invoke_result_t<Job, DatabaseManager&>>) {
+            future.waitForFinished();
+        } else {
+            return future.result();
+        }
+    }
+
+private:
+    DatabaseWorker();
+    ~DatabaseWorker();
+
+    QThread m_thread;
+    QObject* m_context;
+};
+
+} // namespace StudentPicker
+
+#endif // DATABASEWORKER_HPP
@@ -3,21 +3,44 @@
 #include "global.hpp"
 #include <QBuffer>
 #include <QImageReader>
+#include <cmath>
 
 namespace StudentPicker {
 
-ImageProcessor::ImageProcessor() {
+namespace {
+
+QByteArray toJpeg(const QImage& image, int quality) {
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "JPEG", quality);
+    buffer.close();
+    
+    return data;
+}
+
+} // namespace
+
+ImageProcessor::ImageProcessor()
+    : m_encodeCount(0) {
 }
 
 ImageProcessor::~ImageProcessor() {
 }
 
-bool ImageProcessor::loadFromFile(const QString& filePath) {
+bool ImageProcessor::loadFromFile(const QString& filePath, int maxDimension) {
     m_lastError.clear();
     
     QImageReader reader(filePath);
     reader.setAutoTransform(true);
     
+    // Kotak persegi, jadi tetap benar sebelum rotasi EXIF diterapkan
+    QSize sourceSize = reader.size();
+    if (maxDimension > 0 && sourceSize.isValid() &&
+        (sourceSize.width() > maxDimension || sourceSize.height() > maxDimension)) {
+        reader.setScaledSize(sourceSize.scaled(maxDimension, maxDimension, Qt::KeepAspectRatio));
+    }
+    
     m_image = reader.read();
     
     if (m_image.isNull()) {
@@ -71,53 +94,118 @@ QByteArray ImageProcessor::compress(int quality) {
 }
 
 QByteArray ImageProcessor::getCompressedData(int targetSizeKB, int quality) {
+    m_encodeCount = 0;
+    m_lastError.clear();
+    
     if (m_image.isNull()) {
-        Logger::error("Cannot get compressed data: image is null");
+        m_lastError = "Cannot get compressed data: image is null";
+        Logger::error(m_lastError);
         return QByteArray();
     }
     
-    QByteArray data = compress(quality);
-    int sizeKB = data.size() / 1024;
+    const qint64 targetBytes = qint64(targetSizeKB) * 1024;
+    quality = qBound(MIN_QUALITY, quality, 100);
+    
+    QByteArray data = encode(m_image, quality);
+    
+    if (data.isEmpty()) {
+        m_lastError = "Failed to encode image";
+        Logger::error(m_lastError);
+        return QByteArray();
+    }
     
     // Jika ukuran sudah sesuai target, return
-    if (sizeKB <= targetSizeKB) {
-        Logger::info("Image size OK:", sizeKB, "KB (target:", targetSizeKB, "KB)");
+    if (data.size() <= targetBytes) {
+        Logger::info("Image size OK:", data.size() / 1024, "KB (target:", targetSizeKB, "KB)");
         return data;
     }
     
-    // Jika masih terlalu besar, turunkan quality secara bertahap
-    int currentQuality = quality;
-    while (sizeKB > targetSizeKB && currentQuality > 20) {
-        currentQuality -= 10;
-        data = compress(currentQuality);
-        sizeKB = data.size() / 1024;
-        Logger::info("Trying quality:", currentQuality, "Size:", sizeKB, "KB");
-    }
+    // Tahap 1: scale terbesar yang muat di MIN_QUALITY. Resolusi diutamakan
+    // di atas quality, detail yang hilang karena resize tidak kembali lagi
+    // sedangkan artefak JPEG tersamar di ukuran tampilan. Ukuran JPEG kira-kira
+    // sebanding dengan jumlah pixel, jadi scale berikutnya ditebak dari akar
+    // rasio ukuran
+    double scale = 1.0;
+    QImage image = m_image;
+    QByteArray best = quality > MIN_QUALITY ? encode(image, MIN_QUALITY) : data;
     
-    // Jika masih terlalu besar, resize image
-    if (sizeKB > targetSizeKB) {
-        Logger::info("Resizing image to meet target size");
-        
-        int newWidth = m_image.width() * 0.8;
-        int newHeight = m_image.height() * 0.8;
+    while (best.isEmpty() || best.size() > targetBytes) {
+        if (best.isEmpty()) {
+            m_lastError = "Failed to encode image";
+            Logger::error(m_lastError);
+            return QByteArray();
+        }
         
-        QImage resized = m_image.scaled(newWidth, newHeight, 
-                                       Qt::KeepAspectRatio, 
-                                       Qt::SmoothTransformation);
+        if (m_encodeCount >= MAX_ENCODES ||
+            image.width() <= MIN_DIMENSION || image.height() <= MIN_DIMENSION) {
+            m_lastError = QString("Image does not fit in %1 KB").arg(targetSizeKB);
+            Logger::error(m_lastError);
+            return QByteArray();
+        }
         
-        QByteArray resizedData;
-        QBuffer buffer(&resizedData);
-        buffer.open(QIODevice::WriteOnly);
-        resized.save(&buffer, "JPEG", quality);
-        buffer.close();
+        scale *= qMin(std::sqrt(double(targetBytes) / best.size()) * 0.95, 0.9);
+        image = scaledImage(scale);
+        best = encode(image, MIN_QUALITY);
+    }
+    
+    // Tahap 2: bisection quality di scale itu. Di scale 1.0 quality asli
+    // sudah terbukti terlalu besar, di scale lebih kecil belum dicoba
+    int low = MIN_QUALITY;                          // muat
+    int high = scale < 1.0 ? quality + 1 : quality; // terlalu besar
+    
+    while (high - low > 1 && m_encodeCount < MAX_ENCODES) {
+        int mid = (low + high) / 2;
+        QByteArray candidate = encode(image, mid);
         
-        data = resizedData;
-        sizeKB = data.size() / 1024;
-        Logger::info("After resize:", sizeKB, "KB");
+        if (!candidate.isEmpty() && candidate.size() <= targetBytes) {
+            low = mid;
+            best = candidate;
+        } else {
+            high = mid;
+        }
     }
     
-    Logger::info("Final compressed size:", sizeKB, "KB");
-    return data;
+    Logger::info("Compressed at scale", scale, "quality", low, "Size:", best.size() / 1024, "KB,",
+                 m_encodeCount, "encodes");
+    return best;
+}
+
+int ImageProcessor::getEncodeCount() const {
+    return m_encodeCount;
+}
+
+QByteArray ImageProcessor::encode(const QImage& image, int quality) {
+    m_encodeCount++;
+    return toJpeg(image, quality);
+}
+
+QByteArray ImageProcessor::getThumbnail(int width, int height) const {
+    return encodeThumbnail(m_image, width, height);
+}
+
+QByteArray ImageProcessor::encodeThumbnail(const QImage& image, int width, int height) {
+    if (image.isNull()) {
+        return QByteArray();
+    }
+    
+    // Image yang sudah muat di kotak tidak di-scale ulang
+    QImage thumbnail = image;
+    if (image.width() > width || image.height() > height) {
+        thumbnail = image.scaled(width, height, 
+                                 Qt::KeepAspectRatio, 
+                                 Qt::SmoothTransformation);
+    }
+    
+    return toJpeg(thumbnail, THUMBNAIL_QUALITY);
+}
+
+QImage ImageProcessor::scaledImage(double scale) const {
+    int width = qMax(1, int(m_image.width() * scale));
+    int height = qMax(1, int(m_image.height() * scale));
+    
+    return m_image.scaled(width, height, 
+                          Qt::KeepAspectRatio, 
+                          Qt::SmoothTransformation);
 }
 
 QPixmap ImageProcessor::getPixmap(int width, int height) const {
@@ -166,26 +254,58 @@ QByteArray ImageProcessor::compressData(const QByteArray& data, int targetSizeKB
 }
 
 QPixmap ImageProcessor::pixmapFromData(const QByteArray& data, int width, int height) {
-    if (data.isEmpty()) {
+    QImage image = imageFromData(data, width, height);
+    if (image.isNull()) {
         return QPixmap();
     }
+    return QPixmap::fromImage(image);
+}
+
+QImage ImageProcessor::imageFromData(const QByteArray& data, int width, int height) {
+    if (data.isEmpty()) {
+        return QImage();
+    }
     
-    QPixmap pixmap;
-    pixmap.loadFromData(data);
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
     
-    if (width > 0 || height > 0) {
+    QImageReader reader(&buffer);
+    
+    // Ukuran asli dibaca dari header saja, belum decode
+    QSize sourceSize = reader.size();
+    const bool scaleOnRead = sourceSize.isValid() && !sourceSize.isEmpty();
+    
+    if ((width > 0 || height > 0) && scaleOnRead) {
         if (width > 0 && height <= 0) {
-            height = pixmap.height() * width / pixmap.width();
+            height = sourceSize.height() * width / sourceSize.width();
         } else if (height > 0 && width <= 0) {
-            width = pixmap.width() * height / pixmap.height();
+            width = sourceSize.width() * height / sourceSize.height();
         }
         
-        pixmap = pixmap.scaled(width, height, 
-                              Qt::KeepAspectRatio, 
-                              Qt::SmoothTransformation);
+        // Decode langsung di ukuran target, JPEG memakai DCT scaling libjpeg
+        // jadi foto besar tidak pernah di-decode full resolution
+        QSize targetSize = sourceSize.scaled(width, height, Qt::KeepAspectRatio);
+        reader.setScaledSize(targetSize.expandedTo(QSize(1, 1)));
     }
     
-    return pixmap;
+    QImage image = reader.read();
+    if (image.isNull()) {
+        Logger::warn("Failed to decode image data:", reader.errorString());
+        return image;
+    }
+    
+    // Format tanpa ukuran di header: decode penuh, scale sesudahnya
+    if ((width > 0 || height > 0) && !scaleOnRead) {
+        if (width > 0 && height <= 0) {
+            height = qMax(1, image.height() * width / image.width());
+        } else if (height > 0 && width <= 0) {
+            width = qMax(1, image.width() * height / image.height());
+        }
+        
+        image = image.scaled(width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
 }
 
 } // namespace StudentPicker
\ No newline at end of file
@@ -10,11 +10,22 @@ namespace StudentPicker {
 
 class ImageProcessor {
 public:
+    // Batas bawah quality JPEG dan jumlah encode maksimum saat mencari ukuran
+    static constexpr int MIN_QUALITY = 20;
+    static constexpr int MAX_ENCODES = 12;
+    
+    // Sisi terpendek minimum saat memperkecil image agar muat
+    static constexpr int MIN_DIMENSION = 16;
+    
+    // Quality JPEG untuk thumbnail yang disimpan
+    static constexpr int THUMBNAIL_QUALITY = 80;
+    
     ImageProcessor();
     ~ImageProcessor();
     
-    // Load image dari file
-    bool loadFromFile(const QString& filePath);
+    // Load image dari file, maxDimension > 0 membatasi sisi terpanjang
+    // langsung saat decode
+    bool loadFromFile(const QString& filePath, int maxDimension = 0);
     
     // Load image dari QByteArray (dari database)
     bool loadFromData(const QByteArray& data);
@@ -22,9 +33,18 @@ public:
     // Compress image
     QByteArray compress(int quality = 85);
     
-    // Get compressed data (siap disimpan ke database)
+    // Get compressed data (siap disimpan ke database). Dicari scale terbesar
+    // yang muat di MIN_QUALITY, lalu quality terbaik di scale itu. Hasil
+    // selalu <= targetSizeKB, kosong (lihat getLastError) kalau tidak muat
+    // dalam MAX_ENCODES encode
     QByteArray getCompressedData(int targetSizeKB = 200, int quality = 85);
     
+    // Jumlah encode JPEG yang dipakai getCompressedData terakhir
+    int getEncodeCount() const;
+    
+    // Thumbnail JPEG dari image yang sudah di-load
+    QByteArray getThumbnail(int width, int height) const;
+    
     // Get QPixmap untuk ditampilkan di GUI
     QPixmap getPixmap(int width = 0, int height = 0) const;
     
@@ -43,9 +63,22 @@ public:
     // Static helper: Get pixmap from byte array
     static QPixmap pixmapFromData(const QByteArray& data, int width = 0, int height = 0);
     
+    // Static helper: Decode + scale ke QImage, aman dipanggil dari worker thread
+    // (QPixmap hanya boleh dibuat di GUI thread)
+    static QImage imageFromData(const QByteArray& data, int width = 0, int height = 0);
+    
+    // Static helper: Scale image ke dalam kotak width x height lalu encode
+    // JPEG THUMBNAIL_QUALITY, aman dari worker thread
+    static QByteArray encodeThumbnail(const QImage& image, int width, int height);
+    
 private:
+    // Encode JPEG tanpa log, dihitung di m_encodeCount
+    QByteArray encode(const QImage& image, int quality);
+    QImage scaledImage(double scale) const;
+    
     QImage m_image;
     QString m_lastError;
+    int m_encodeCount;
 };
 
 } // namespace StudentPicker
@@ -0,0 +1,206 @@
+#include "ImportPipeline.hpp"
+#include "CSVReader.hpp"
+#include "XLSXReader.hpp"
+#include "StudentImporter.hpp"
+#include "DatabaseWorker.hpp"
+#include "logger.hpp"
+#include <QThread>
+#include <QThreadPool>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+namespace StudentPicker {
+
+namespace {
+
+const QString WRITER_CONNECTION_NAME = "StudentPickerImportWriter";
+
+} // namespace
+
+ImportPipeline::ImportPipeline()
+    : m_queue(QUEUE_CAPACITY), m_importedCount(0) {
+}
+
+ImportPipeline::~ImportPipeline() {
+}
+
+bool ImportPipeline::run(const QStringList& filePaths) {
+    m_results.clear();
+    m_results.resize(filePaths.size());
+    for (int i = 0; i < filePaths.size(); i++) {
+        m_results[i].filePath = filePaths[i];
+    }
+
+    if (filePaths.isEmpty()) {
+        return true;
+    }
+
+    m_pendingFiles.storeRelaxed(filePaths.size());
+
+    // Single writer, SQLite writes stay serialized
+    QThread* writer = QThread::create([this]() { writeBatches(); });
+    writer->start();
+
+    // Parsers scale across cores, the bounded queue caps memory in flight
+    QThreadPool pool;
+    for (int i = 0; i < filePaths.size(); i++) {
+        pool.start([this, i]() { parseFile(i); });
+    }
+
+    pool.waitForDone();
+    writer->wait();
+    delete writer;
+
+    // Rows were written through another connection, the caches belong to
+    // the database thread
+    DatabaseWorker::instance().run([](DatabaseManager& db) {
+        db.invalidateCaches();
+    });
+
+    if (hasFailed()) {
+        Logger::error("Multi-file import failed:", m_lastError);
+        return false;
+    }
+
+    Logger::info("Multi-file import committed", m_importedCount, "students from",
+                 filePaths.size(), "files");
+    return true;
+}
+
+template<typename Reader>
+void ImportPipeline::readInto(Reader& reader, ImportFileResult& result) {
+    bool missingColumns = false;
+    bool aborted = false;
+
+    bool ok = reader.readFile(result.filePath, [&](const QVector<QVariantMap>& rows) {
+        if (!hasRequiredColumns(reader.getHeaders())) {
+            missingColumns = true;
+            return false;
+        }
+        if (!m_queue.push(toStudents(rows))) {
+            aborted = true;
+            return false;
+        }
+        return true;
+    });
+
+    result.rowCount = reader.getRowCount();
+    result.skippedCount = reader.getSkippedCount();
+
+    if (aborted) {
+        result.error = "Import aborted";
+    } else if (missingColumns || (ok && !hasRequiredColumns(reader.getHeaders()))) {
+        result.error = "File must contain columns: Name, StudentID, Class";
+    } else if (!ok) {
+        result.error = reader.getLastError();
+    }
+}
+
+void ImportPipeline::parseFile(int index) {
+    ImportFileResult& result = m_results[index];
+    const QString suffix = QFileInfo(result.filePath).suffix().toLower();
+
+    if (!hasFailed()) {
+        if (suffix == "csv") {
+            CSVReader reader;
+            readInto(reader, result);
+        } else if (suffix == "xlsx") {
+            XLSXReader reader;
+            readInto(reader, result);
+        } else {
+            result.error = "Unsupported file format";
+        }
+
+        // The first real failure aborts the others, not the abort itself
+        if (!result.error.isEmpty() && !hasFailed()) {
+            fail(QFileInfo(result.filePath).fileName() + ": " + result.error);
+        }
+    }
+
+    // Last parser out closes the queue so the writer can commit
+    if (m_pendingFiles.fetchAndSubOrdered(1) == 1) {
+        m_queue.close();
+    }
+}
+
+void ImportPipeline::writeBatches() {
+    {
+        QSqlDatabase database = DatabaseManager::instance().openWorkerConnection(WRITER_CONNECTION_NAME);
+
+        if (!database.isOpen()) {
+            fail("Failed to open import connection: " + database.lastError().text());
+        } else {
+            StudentImporter importer(database);
+            bool ok = importer.begin();
+
+            QVector<Student> batch;
+            while (ok && m_queue.pop(batch)) {
+                ok = importer.addBatch(batch);
+            }
+
+            if (ok && !hasFailed()) {
+                ok = importer.commit();
+            }
+
+            if (ok && !hasFailed()) {
+                m_importedCount = importer.importedCount();
+            } else {
+                importer.rollback();
+                if (!ok) {
+                    fail(importer.getLastError());
+                }
+            }
+        }
+    }
+
+    DatabaseManager::closeWorkerConnection(WRITER_CONNECTION_NAME);
+}
+
+QVector<ImportFileResult> ImportPipeline::getResults() const {
+    return m_results;
+}
+
+int ImportPipeline::getImportedCount() const {
+    return m_importedCount;
+}
+
+QString ImportPipeline::getLastError() const {
+    return m_lastError;
+}
+
+bool ImportPipeline::hasRequiredColumns(const QStringList& headers) {
+    return headers.contains("Name") && headers.contains("StudentID") && headers.contains("Class");
+}
+
+QVector<Student> ImportPipeline::toStudents(const QVector<QVariantMap>& rows) {
+    QVector<Student> students;
+    students.reserve(rows.size());
+
+    for (const QVariantMap& row : rows) {
+        Student student;
+        student.name = row["Name"].toString();
+        student.studentId = row["StudentID"].toString();
+        student.className = row["Class"].toString();
+
+        students.append(student);
+    }
+
+    return students;
+}
+
+void ImportPipeline::fail(const QString& error) {
+    QMutexLocker locker(&m_errorMutex);
+    if (m_lastError.isEmpty()) {
+        m_lastError = error.isEmpty() ? QString("Import failed") : error;
+    }
+
+    // Producers blocked on a full queue must not wait for a dead writer
+    m_queue.abort();
+}
+
+bool ImportPipeline::hasFailed() {
+    QMutexLocker locker(&m_errorMutex);
+    return !m_lastError.isEmpty();
+}
+
+} // namespace StudentPicker
@@ -0,0 +1,75 @@
+#ifndef IMPORTPIPELINE_HPP
+#define IMPORTPIPELINE_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QVariantMap>
+#include <QMutex>
+#include <QAtomicInt>
+#include "DatabaseManager.hpp"
+#include "BoundedQueue.hpp"
+
+namespace StudentPicker {
+
+struct ImportFileResult {
+    QString filePath;
+    int rowCount;
+    int skippedCount;
+    QString error;
+
+    ImportFileResult() : rowCount(0), skippedCount(0) {}
+};
+
+// Multi-file import. Files are parsed in parallel on a thread pool and
+// the validated row batches flow through a bounded queue to a single
+// writer thread, which owns its own connection and inserts everything in
+// one transaction. Any failing file rolls the whole import back.
+class ImportPipeline {
+public:
+    static const int QUEUE_CAPACITY = 8;
+
+    ImportPipeline();
+    ~ImportPipeline();
+
+    // Import all files, blocks until the writer has committed or rolled
+    // back. A pipeline instance runs once. Call it from a background thread,
+    // not from a DatabaseWorker job, it would hold the database thread.
+    bool run(const QStringList& filePaths);
+
+    // Per file outcome of the last run
+    QVector<ImportFileResult> getResults() const;
+
+    // Rows committed by the last run
+    int getImportedCount() const;
+
+    QString getLastError() const;
+
+    // Row conversion shared with the single-file import
+    static bool hasRequiredColumns(const QStringList& headers);
+    static QVector<Student> toStudents(const QVector<QVariantMap>& rows);
+
+private:
+    // Parse one file and push its batches, runs on the thread pool
+    void parseFile(int index);
+
+    // Drain the queue into the database, runs on the writer thread
+    void writeBatches();
+
+    template<typename Reader>
+    void readInto(Reader& reader, ImportFileResult& result);
+
+    void fail(const QString& error);
+    bool hasFailed();
+
+    BoundedQueue<QVector<Student>> m_queue;
+    QVector<ImportFileResult> m_results;
+    QAtomicInt m_pendingFiles;
+    QMutex m_errorMutex;
+    QString m_lastError;
+    int m_importedCount;
+};
+
+} // namespace StudentPicker
+
+#endif // IMPORTPIPELINE_HPP
@@ -0,0 +1,160 @@
+#include "PhotoImportPipeline.hpp"
+#include "ImageProcessor.hpp"
+#include "DatabaseWorker.hpp"
+#include "global.hpp"
+#include "logger.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QMutexLocker>
+
+namespace StudentPicker {
+
+const QStringList PhotoImportPipeline::IMAGE_FILTERS = {
+    "*.jpg", "*.jpeg", "*.png", "*.bmp"
+};
+
+PhotoImportPipeline::PhotoImportPipeline()
+    : m_queue(QUEUE_CAPACITY), m_updatedCount(0) {
+}
+
+PhotoImportPipeline::~PhotoImportPipeline() {
+}
+
+bool PhotoImportPipeline::run(const QString& directory) {
+    QDir dir(directory);
+    if (!dir.exists()) {
+        m_lastError = "Folder not found: " + directory;
+        Logger::error(m_lastError);
+        return false;
+    }
+
+    const QFileInfoList files = dir.entryInfoList(
+        IMAGE_FILTERS, QDir::Files | QDir::Readable, QDir::Name | QDir::IgnoreCase);
+
+    const QHash<QString, int> rowIds = DatabaseWorker::instance().runSync([](DatabaseManager& db) {
+        return db.getStudentRowIdsByStudentId();
+    });
+
+    QVector<QPair<QString, int>> matched;
+    for (const QFileInfo& file : files) {
+        auto it = rowIds.constFind(file.completeBaseName());
+        if (it == rowIds.constEnd()) {
+            m_unmatchedFiles.append(file.fileName());
+        } else {
+            matched.append(qMakePair(file.absoluteFilePath(), it.value()));
+        }
+    }
+
+    Logger::info("Photo import:", matched.size(), "of", files.size(), "files match a student");
+
+    if (matched.isEmpty()) {
+        return true;
+    }
+
+    m_pendingFiles.storeRelaxed(matched.size());
+
+    // Decoding and compressing scale across cores, the bounded queue caps
+    // the compressed photos waiting for the writer
+    QThreadPool pool;
+    for (const QPair<QString, int>& item : matched) {
+        pool.start([this, item]() { processFile(item.first, item.second); });
+    }
+
+    // This thread collects the batches, each one is written as a single
+    // job on the database thread
+    QVector<StudentPhotoUpdate> batch;
+    batch.reserve(BATCH_SIZE);
+
+    bool ok = true;
+    StudentPhotoUpdate photo;
+    while (ok && m_queue.pop(photo)) {
+        batch.append(photo);
+        if (batch.size() >= BATCH_SIZE) {
+            ok = writeBatch(batch);
+        }
+    }
+
+    if (ok && !batch.isEmpty()) {
+        ok = writeBatch(batch);
+    }
+
+    if (!ok) {
+        // Release producers blocked on a full queue
+        m_queue.abort();
+    }
+
+    pool.waitForDone();
+
+    if (m_updatedCount > 0) {
+        DatabaseWorker::instance().run([](DatabaseManager& db) {
+            db.invalidateCaches();
+        });
+    }
+
+    Logger::info("Photo import updated", m_updatedCount, "students,",
+                 m_failedFiles.size(), "files failed,", m_unmatchedFiles.size(), "unmatched");
+    return ok;
+}
+
+void PhotoImportPipeline::processFile(const QString& filePath, int studentRowId) {
+    ImageProcessor processor;
+    StudentPhotoUpdate update;
+    update.studentRowId = studentRowId;
+
+    if (processor.loadFromFile(filePath, GlobalConf::MAX_PHOTO_DIMENSION)) {
+        update.photo = processor.getCompressedData(GlobalConf::MAX_IMAGE_SIZE_KB);
+
+        // Made from the decoded image, the writer never decodes again
+        update.thumbnails.display = processor.getThumbnail(GlobalConf::DISPLAY_IMAGE_WIDTH,
+                                                           GlobalConf::DISPLAY_IMAGE_HEIGHT);
+        update.thumbnails.list = processor.getThumbnail(GlobalConf::LIST_THUMBNAIL_SIZE,
+                                                        GlobalConf::LIST_THUMBNAIL_SIZE);
+    }
+
+    if (update.photo.isEmpty()) {
+        QMutexLocker locker(&m_failedMutex);
+        m_failedFiles.append(QFileInfo(filePath).fileName());
+    } else {
+        // false only when the writer has aborted, nothing left to do then
+        m_queue.push(update);
+    }
+
+    // Last file out closes the queue so the writer can finish
+    if (m_pendingFiles.fetchAndSubOrdered(1) == 1) {
+        m_queue.close();
+    }
+}
+
+bool PhotoImportPipeline::writeBatch(QVector<StudentPhotoUpdate>& batch) {
+    const QString error = DatabaseWorker::instance().runSync([&batch](DatabaseManager& db) {
+        return db.updateStudentPhotos(batch) ? QString() : db.getLastError();
+    });
+
+    if (!error.isEmpty()) {
+        m_lastError = error;
+        return false;
+    }
+
+    m_updatedCount += batch.size();
+    batch.clear();
+    return true;
+}
+
+int PhotoImportPipeline::getUpdatedCount() const {
+    return m_updatedCount;
+}
+
+QStringList PhotoImportPipeline::getUnmatchedFiles() const {
+    return m_unmatchedFiles;
+}
+
+QStringList PhotoImportPipeline::getFailedFiles() const {
+    return m_failedFiles;
+}
+
+QString PhotoImportPipeline::getLastError() const {
+    return m_lastError;
+}
+
+} // namespace StudentPicker
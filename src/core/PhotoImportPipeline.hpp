@@ -0,0 +1,59 @@
+#ifndef PHOTOIMPORTPIPELINE_HPP
+#define PHOTOIMPORTPIPELINE_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMutex>
+#include <QAtomicInt>
+#include "DatabaseManager.hpp"
+#include "BoundedQueue.hpp"
+
+namespace StudentPicker {
+
+// Bulk photo import from a folder. Each image whose file name (without
+// extension) equals a StudentID is decoded, resized and compressed, and its
+// thumbnails are made, on a thread pool. The calling thread queues the
+// results to the DatabaseWorker in BATCH_SIZE transactions, so run() belongs
+// on a background thread, never in a DatabaseWorker job. Files that fail to
+// decode are skipped and reported.
+class PhotoImportPipeline {
+public:
+    static const int QUEUE_CAPACITY = 64;
+    static const int BATCH_SIZE = 200;
+
+    PhotoImportPipeline();
+    ~PhotoImportPipeline();
+
+    // Import every matching image of the folder, false on a database error.
+    // Batches committed before the error stay committed.
+    bool run(const QString& directory);
+
+    // Outcome of the last run
+    int getUpdatedCount() const;
+    QStringList getUnmatchedFiles() const;
+    QStringList getFailedFiles() const;
+
+    QString getLastError() const;
+
+    // Image files picked up from the folder
+    static const QStringList IMAGE_FILTERS;
+
+private:
+    // Decode and compress one file and queue it, runs on the thread pool
+    void processFile(const QString& filePath, int studentRowId);
+
+    bool writeBatch(QVector<StudentPhotoUpdate>& batch);
+
+    BoundedQueue<StudentPhotoUpdate> m_queue;
+    QAtomicInt m_pendingFiles;
+    QMutex m_failedMutex;
+    QStringList m_unmatchedFiles;
+    QStringList m_failedFiles;
+    QString m_lastError;
+    int m_updatedCount;
+};
+
+} // namespace StudentPicker
+
+#endif // PHOTOIMPORTPIPELINE_HPP
@@ -0,0 +1,229 @@
+#include "PhotoStore.hpp"
+#include "logger.hpp"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QCryptographicHash>
+#include <QVector>
+#include <QPair>
+
+namespace StudentPicker {
+
+PhotoStore::PhotoStore(const QSqlDatabase& database)
+    : m_database(database) {
+}
+
+PhotoStore::~PhotoStore() {
+}
+
+QByteArray PhotoStore::hashOf(const QByteArray& photo) {
+    return QCryptographicHash::hash(photo, QCryptographicHash::Blake2b_256);
+}
+
+bool PhotoStore::assign(int studentRowId, const QByteArray& photo, bool* changed) {
+    if (changed) {
+        *changed = false;
+    }
+
+    bool found = false;
+    QByteArray oldHash = currentHash(studentRowId, &found);
+    if (!found) {
+        return fail("Failed to assign photo:", "Student not found");
+    }
+
+    QByteArray newHash = photo.isEmpty() ? QByteArray() : hashOf(photo);
+    if (newHash == oldHash) {
+        return true;
+    }
+
+    // Join the caller's transaction if there is one
+    bool ownTransaction = m_database.transaction();
+
+    bool success = newHash.isEmpty() || addReference(newHash, photo);
+
+    if (success) {
+        QSqlQuery query(m_database);
+        query.prepare(newHash.isEmpty()
+            ? "UPDATE students SET photo_hash = NULL, photo_version = photo_version + 1 WHERE id = :id"
+            : "UPDATE students SET photo_hash = :hash, photo_version = photo_version + 1 WHERE id = :id");
+        if (!newHash.isEmpty()) {
+            query.bindValue(":hash", newHash);
+        }
+        query.bindValue(":id", studentRowId);
+
+        success = query.exec();
+        if (!success) {
+            fail("Failed to assign photo:", query.lastError().text());
+        }
+    }
+
+    if (success && !oldHash.isEmpty()) {
+        success = dropReference(oldHash);
+    }
+
+    if (!success) {
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return false;
+    }
+
+    if (ownTransaction) {
+        m_database.commit();
+    }
+
+    if (changed) {
+        *changed = true;
+    }
+    return true;
+}
+
+bool PhotoStore::release(int studentRowId) {
+    QByteArray hash = currentHash(studentRowId);
+    if (hash.isEmpty()) {
+        return true;
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare("UPDATE students SET photo_hash = NULL WHERE id = :id");
+    query.bindValue(":id", studentRowId);
+    if (!query.exec()) {
+        return fail("Failed to release photo:", query.lastError().text());
+    }
+
+    return dropReference(hash);
+}
+
+bool PhotoStore::clear() {
+    QSqlQuery query(m_database);
+    if (!query.exec("DELETE FROM photos")) {
+        return fail("Failed to clear photos:", query.lastError().text());
+    }
+    return true;
+}
+
+bool PhotoStore::migrateInlinePhotos(int* migratedCount) {
+    if (migratedCount) {
+        *migratedCount = 0;
+    }
+
+    QSqlQuery select(m_database);
+    select.prepare("SELECT id, photo FROM students "
+                   "WHERE photo IS NOT NULL AND length(photo) > 0 LIMIT 100");
+
+    // The content is the same, photo_version and the thumbnails stay valid
+    QSqlQuery update(m_database);
+    update.prepare("UPDATE students SET photo_hash = :hash, photo = NULL WHERE id = :id");
+
+    bool ownTransaction = m_database.transaction();
+    int migrated = 0;
+
+    // Each round clears the inline photos it read, so the next one moves on
+    while (true) {
+        if (!select.exec()) {
+            fail("Failed to read inline photos:", select.lastError().text());
+            break;
+        }
+
+        QVector<QPair<int, QByteArray>> rows;
+        while (select.next()) {
+            rows.append(qMakePair(select.value(0).toInt(), select.value(1).toByteArray()));
+        }
+        select.finish();
+
+        if (rows.isEmpty()) {
+            break;
+        }
+
+        for (const QPair<int, QByteArray>& row : rows) {
+            QByteArray hash = hashOf(row.second);
+            if (!addReference(hash, row.second)) {
+                break;
+            }
+
+            update.bindValue(":hash", hash);
+            update.bindValue(":id", row.first);
+            if (!update.exec()) {
+                fail("Failed to migrate photo:", update.lastError().text());
+                break;
+            }
+            migrated++;
+        }
+
+        if (!m_lastError.isEmpty()) {
+            break;
+        }
+    }
+
+    if (!m_lastError.isEmpty()) {
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return false;
+    }
+
+    if (ownTransaction) {
+        m_database.commit();
+    }
+
+    if (migrated > 0) {
+        Logger::info("Moved", migrated, "inline photos into the photo store");
+    }
+    if (migratedCount) {
+        *migratedCount = migrated;
+    }
+    return true;
+}
+
+QString PhotoStore::getLastError() const {
+    return m_lastError;
+}
+
+QByteArray PhotoStore::currentHash(int studentRowId, bool* found) {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT photo_hash FROM students WHERE id = :id");
+    query.bindValue(":id", studentRowId);
+
+    bool exists = query.exec() && query.next();
+    if (found) {
+        *found = exists;
+    }
+    return exists ? query.value(0).toByteArray() : QByteArray();
+}
+
+bool PhotoStore::addReference(const QByteArray& hash, const QByteArray& photo) {
+    QSqlQuery query(m_database);
+    query.prepare("INSERT INTO photos (hash, data, ref_count) VALUES (:hash, :data, 1) "
+                  "ON CONFLICT(hash) DO UPDATE SET ref_count = ref_count + 1");
+    query.bindValue(":hash", hash);
+    query.bindValue(":data", photo);
+
+    if (!query.exec()) {
+        return fail("Failed to store photo:", query.lastError().text());
+    }
+    return true;
+}
+
+bool PhotoStore::dropReference(const QByteArray& hash) {
+    QSqlQuery query(m_database);
+    query.prepare("UPDATE photos SET ref_count = ref_count - 1 WHERE hash = :hash");
+    query.bindValue(":hash", hash);
+    if (!query.exec()) {
+        return fail("Failed to release photo:", query.lastError().text());
+    }
+
+    query.prepare("DELETE FROM photos WHERE hash = :hash AND ref_count <= 0");
+    query.bindValue(":hash", hash);
+    if (!query.exec()) {
+        return fail("Failed to release photo:", query.lastError().text());
+    }
+    return true;
+}
+
+bool PhotoStore::fail(const QString& context, const QString& error) {
+    m_lastError = error;
+    Logger::error(context, m_lastError);
+    return false;
+}
+
+} // namespace StudentPicker
@@ -0,0 +1,50 @@
+#ifndef PHOTOSTORE_HPP
+#define PHOTOSTORE_HPP
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QByteArray>
+
+namespace StudentPicker {
+
+// Content-addressed photo storage in the photos table. Each distinct image
+// is stored once under its BLAKE2b-256 digest, students.photo_hash points
+// at it and ref_count tracks how many students share it. The last release
+// deletes the image.
+class PhotoStore {
+public:
+    explicit PhotoStore(const QSqlDatabase& database);
+    ~PhotoStore();
+
+    static QByteArray hashOf(const QByteArray& photo);
+
+    // Point a student at a photo (empty = no photo) and release the previous
+    // one. photo_version only moves when the content changes, reported
+    // through changed.
+    bool assign(int studentRowId, const QByteArray& photo, bool* changed = nullptr);
+
+    // Drop the student's reference, call before deleting the student row
+    bool release(int studentRowId);
+
+    // Drop every photo, for when all students are deleted
+    bool clear();
+
+    // Move photos still stored inline in students.photo into the store,
+    // the number moved is reported through migratedCount
+    bool migrateInlinePhotos(int* migratedCount = nullptr);
+
+    QString getLastError() const;
+
+private:
+    QByteArray currentHash(int studentRowId, bool* found = nullptr);
+    bool addReference(const QByteArray& hash, const QByteArray& photo);
+    bool dropReference(const QByteArray& hash);
+    bool fail(const QString& context, const QString& error);
+
+    QSqlDatabase m_database;
+    QString m_lastError;
+};
+
+} // namespace StudentPicker
+
+#endif // PHOTOSTORE_HPP
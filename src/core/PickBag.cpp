@@ -0,0 +1,214 @@
+#include "PickBag.hpp"
+#include "logger.hpp"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QRandomGenerator>
+#include <utility>
+
+namespace StudentPicker {
+
+PickBag::PickBag(const QSqlDatabase& database)
+    : m_database(database) {
+}
+
+PickBag::~PickBag() {
+}
+
+int PickBag::size(int classId) {
+    // Slots are dense, MAX(slot) is answered from the primary key index
+    QSqlQuery query(m_database);
+    query.prepare("SELECT MAX(slot) FROM pick_bags WHERE class_id = :class_id");
+    query.bindValue(":class_id", classId);
+
+    if (query.exec() && query.next() && !query.value(0).isNull()) {
+        return query.value(0).toInt() + 1;
+    }
+    return 0;
+}
+
+int PickBag::pop(int classId) {
+    // Read and delete in one transaction, a crash in between must not
+    // hand the same student out twice. Joins the caller's transaction.
+    bool ownTransaction = m_database.transaction();
+
+    QSqlQuery query(m_database);
+    query.prepare("SELECT slot, student_row_id FROM pick_bags "
+                  "WHERE class_id = :class_id ORDER BY slot DESC LIMIT 1");
+    query.bindValue(":class_id", classId);
+
+    if (!query.exec() || !query.next()) {
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return -1;
+    }
+
+    int slot = query.value(0).toInt();
+    int studentRowId = query.value(1).toInt();
+    query.finish();
+
+    QSqlQuery deleteQuery(m_database);
+    deleteQuery.prepare("DELETE FROM pick_bags WHERE class_id = :class_id AND slot = :slot");
+    deleteQuery.bindValue(":class_id", classId);
+    deleteQuery.bindValue(":slot", slot);
+
+    if (!deleteQuery.exec()) {
+        QString error = deleteQuery.lastError().text();
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        fail("Failed to pop pick bag:", error);
+        return -1;
+    }
+
+    if (ownTransaction && !m_database.commit()) {
+        QString error = m_database.lastError().text();
+        m_database.rollback();
+        fail("Failed to pop pick bag:", error);
+        return -1;
+    }
+
+    return studentRowId;
+}
+
+bool PickBag::refill(int classId, QVector<int> studentRowIds) {
+    // Fisher-Yates shuffle
+    QRandomGenerator* rng = QRandomGenerator::global();
+    for (int i = studentRowIds.size() - 1; i > 0; i--) {
+        int j = rng->bounded(i + 1);
+        std::swap(studentRowIds[i], studentRowIds[j]);
+    }
+
+    // Join the caller's transaction if there is one
+    bool ownTransaction = m_database.transaction();
+
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM pick_bags WHERE class_id = :class_id");
+    query.bindValue(":class_id", classId);
+    bool success = query.exec();
+
+    if (success) {
+        query.prepare("INSERT INTO pick_bags (class_id, slot, student_row_id) "
+                      "VALUES (:class_id, :slot, :student_row_id)");
+        for (int slot = 0; slot < studentRowIds.size(); slot++) {
+            query.bindValue(":class_id", classId);
+            query.bindValue(":slot", slot);
+            query.bindValue(":student_row_id", studentRowIds[slot]);
+            if (!query.exec()) {
+                success = false;
+                break;
+            }
+        }
+    }
+
+    if (!success) {
+        QString error = query.lastError().text();
+        if (ownTransaction) {
+            m_database.rollback();
+        }
+        return fail("Failed to refill pick bag:", error);
+    }
+
+    if (ownTransaction && !m_database.commit()) {
+        QString error = m_database.lastError().text();
+        m_database.rollback();
+        return fail("Failed to refill pick bag:", error);
+    }
+
+    Logger::info("Pick bag refilled for class", classId, "with", studentRowIds.size(), "students");
+    return true;
+}
+
+bool PickBag::insert(int classId, int studentRowId) {
+    int count = size(classId);
+
+    // No running cycle, the next refill picks the student up
+    if (count == 0) {
+        return true;
+    }
+
+    // Uniform slot in 0..count, the student in that slot moves to the end
+    int slot = QRandomGenerator::global()->bounded(count + 1);
+
+    QSqlQuery query(m_database);
+    if (slot != count) {
+        query.prepare("UPDATE pick_bags SET slot = :last WHERE class_id = :class_id AND slot = :slot");
+        query.bindValue(":last", count);
+        query.bindValue(":class_id", classId);
+        query.bindValue(":slot", slot);
+        if (!query.exec()) {
+            return fail("Failed to insert into pick bag:", query.lastError().text());
+        }
+    }
+
+    query.prepare("INSERT INTO pick_bags (class_id, slot, student_row_id) "
+                  "VALUES (:class_id, :slot, :student_row_id)");
+    query.bindValue(":class_id", classId);
+    query.bindValue(":slot", slot);
+    query.bindValue(":student_row_id", studentRowId);
+    if (!query.exec()) {
+        return fail("Failed to insert into pick bag:", query.lastError().text());
+    }
+
+    return true;
+}
+
+bool PickBag::remove(int studentRowId) {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT class_id, slot FROM pick_bags WHERE student_row_id = :student_row_id");
+    query.bindValue(":student_row_id", studentRowId);
+
+    if (!query.exec()) {
+        return fail("Failed to remove from pick bag:", query.lastError().text());
+    }
+
+    // Already picked this cycle or no running cycle
+    if (!query.next()) {
+        return true;
+    }
+
+    int classId = query.value(0).toInt();
+    int slot = query.value(1).toInt();
+    query.finish();
+
+    query.prepare("DELETE FROM pick_bags WHERE student_row_id = :student_row_id");
+    query.bindValue(":student_row_id", studentRowId);
+    if (!query.exec()) {
+        return fail("Failed to remove from pick bag:", query.lastError().text());
+    }
+
+    // Move the last slot into the hole to keep slots dense
+    int last = size(classId) - 1;
+    if (slot < last) {
+        query.prepare("UPDATE pick_bags SET slot = :slot WHERE class_id = :class_id AND slot = :last");
+        query.bindValue(":slot", slot);
+        query.bindValue(":class_id", classId);
+        query.bindValue(":last", last);
+        if (!query.exec()) {
+            return fail("Failed to remove from pick bag:", query.lastError().text());
+        }
+    }
+
+    return true;
+}
+
+bool PickBag::clear() {
+    QSqlQuery query(m_database);
+    if (!query.exec("DELETE FROM pick_bags")) {
+        return fail("Failed to clear pick bags:", query.lastError().text());
+    }
+    return true;
+}
+
+QString PickBag::getLastError() const {
+    return m_lastError;
+}
+
+bool PickBag::fail(const QString& context, const QString& error) {
+    m_lastError = error;
+    Logger::error(context, m_lastError);
+    return false;
+}
+
+} // namespace StudentPicker
@@ -0,0 +1,48 @@
+#ifndef PICKBAG_HPP
+#define PICKBAG_HPP
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+namespace StudentPicker {
+
+// Persisted shuffle bag per class, stored in the pick_bags table.
+// Each class bag holds the students not yet picked in the current cycle
+// in slots 0..n-1, the pick order is a Fisher-Yates permutation and a
+// pick pops the highest slot.
+class PickBag {
+public:
+    explicit PickBag(const QSqlDatabase& database);
+    ~PickBag();
+
+    // Remaining students in the class bag (0 = cycle finished / not started)
+    int size(int classId);
+
+    // Pop the next student row id, -1 if the bag is empty
+    int pop(int classId);
+
+    // Start a new cycle with a shuffled permutation of the given ids
+    bool refill(int classId, QVector<int> studentRowIds);
+
+    // Put a new student in a random slot of a running cycle
+    bool insert(int classId, int studentRowId);
+
+    // Take a student out of whatever bag holds it
+    bool remove(int studentRowId);
+
+    // Drop every bag
+    bool clear();
+
+    QString getLastError() const;
+
+private:
+    bool fail(const QString& context, const QString& error);
+
+    QSqlDatabase m_database;
+    QString m_lastError;
+};
+
+} // namespace StudentPicker
+
+#endif // PICKBAG_HPP
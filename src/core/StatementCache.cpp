@@ -0,0 +1,92 @@
+#include "StatementCache.hpp"
+#include "logger.hpp"
+#include <QSqlError>
+#include <QVariant>
+
+namespace StudentPicker {
+
+StatementCache::Lease::Lease(Entry* entry, bool owned)
+    : m_entry(entry), m_owned(owned) {
+    m_entry->leased = true;
+}
+
+StatementCache::Lease::Lease(Lease&& other) noexcept
+    : m_entry(other.m_entry), m_owned(other.m_owned) {
+    other.m_entry = nullptr;
+    other.m_owned = false;
+}
+
+StatementCache::Lease::~Lease() {
+    if (!m_entry) {
+        return;
+    }
+
+    // Ends the result set so SQLite can reset the statement, the
+    // prepared form stays valid for the next exec()
+    m_entry->query.finish();
+    m_entry->leased = false;
+
+    if (m_owned) {
+        delete m_entry;
+    }
+}
+
+StatementCache::StatementCache()
+    : m_hits(0), m_misses(0) {
+}
+
+StatementCache::~StatementCache() {
+    reset();
+}
+
+void StatementCache::reset(const QSqlDatabase& database) {
+    // Statements must go before their connection is closed or removed
+    qDeleteAll(m_entries);
+    m_entries.clear();
+    m_database = database;
+}
+
+StatementCache::Lease StatementCache::prepare(const QString& sql) {
+    Entry* entry = m_entries.value(sql, nullptr);
+
+    if (entry && !entry->leased) {
+        m_hits++;
+        // Values of the previous call must not leak into this one
+        const int count = entry->query.boundValues().size();
+        for (int i = 0; i < count; i++) {
+            entry->query.bindValue(i, QVariant());
+        }
+        return Lease(entry, false);
+    }
+
+    m_misses++;
+    Entry* fresh = new Entry(m_database);
+    bool prepared = fresh->query.prepare(sql);
+
+    if (!prepared) {
+        Logger::error("Failed to prepare statement:", fresh->query.lastError().text());
+    }
+
+    // Only a statement that is not in the cache yet and compiled fine is
+    // kept, a nested use of the same SQL gets its own one-off copy
+    if (entry || !prepared) {
+        return Lease(fresh, true);
+    }
+
+    m_entries.insert(sql, fresh);
+    return Lease(fresh, false);
+}
+
+int StatementCache::size() const {
+    return m_entries.size();
+}
+
+quint64 StatementCache::getHitCount() const {
+    return m_hits;
+}
+
+quint64 StatementCache::getMissCount() const {
+    return m_misses;
+}
+
+} // namespace StudentPicker
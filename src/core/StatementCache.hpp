@@ -0,0 +1,70 @@
+#ifndef STATEMENTCACHE_HPP
+#define STATEMENTCACHE_HPP
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QHash>
+
+namespace StudentPicker {
+
+// Prepared statements of one connection keyed by their SQL text, so the
+// same statement is compiled once instead of on every call. A statement
+// is handed out as a Lease that finishes it when it goes out of scope,
+// which releases the read snapshot but keeps the compiled statement.
+class StatementCache {
+    struct Entry {
+        QSqlQuery query;
+        bool leased;
+
+        explicit Entry(const QSqlDatabase& database) : query(database), leased(false) {}
+    };
+
+public:
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        QSqlQuery& operator*() const { return m_entry->query; }
+        QSqlQuery* operator->() const { return &m_entry->query; }
+
+    private:
+        friend class StatementCache;
+        Lease(Entry* entry, bool owned);
+
+        Entry* m_entry;
+        // Not cached (failed prepare or nested use), deleted with the lease
+        bool m_owned;
+    };
+
+    StatementCache();
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // Drop every statement and prepare the next ones on this connection
+    void reset(const QSqlDatabase& database = QSqlDatabase());
+
+    // Prepared statement for the SQL text. Bound values are cleared; a
+    // statement that is still leased gets an uncached copy instead.
+    Lease prepare(const QString& sql);
+
+    int size() const;
+    quint64 getHitCount() const;
+    quint64 getMissCount() const;
+
+private:
+    QSqlDatabase m_database;
+    QHash<QString, Entry*> m_entries;
+    quint64 m_hits;
+    quint64 m_misses;
+};
+
+} // namespace StudentPicker
+
+#endif // STATEMENTCACHE_HPP
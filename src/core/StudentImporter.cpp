@@ -0,0 +1,157 @@
+#include "StudentImporter.hpp"
+#include "logger.hpp"
+#include <QSqlError>
+#include <QVariant>
+
+namespace StudentPicker {
+
+StudentImporter::StudentImporter(const QSqlDatabase& database)
+    : m_database(database), m_pickBag(database), m_photoStore(database), m_importedCount(0), m_active(false) {
+}
+
+StudentImporter::~StudentImporter() {
+    if (m_active) {
+        rollback();
+    }
+}
+
+bool StudentImporter::begin() {
+    m_lastError.clear();
+    m_classIds.clear();
+    m_activeBags.clear();
+    m_importedCount = 0;
+
+    if (!m_database.transaction()) {
+        return fail("Failed to start import transaction:", m_database.lastError().text());
+    }
+    m_active = true;
+
+    QSqlQuery classQuery("SELECT id, name FROM classes", m_database);
+    while (classQuery.next()) {
+        m_classIds.insert(classQuery.value(1).toString(), classQuery.value(0).toInt());
+    }
+
+    m_insertClass = QSqlQuery(m_database);
+    m_insertStudent = QSqlQuery(m_database);
+
+    if (!m_insertClass.prepare("INSERT INTO classes (name) VALUES (:name)")) {
+        return fail("Failed to prepare class insert:", m_insertClass.lastError().text());
+    }
+
+    if (!m_insertStudent.prepare("INSERT INTO students (name, student_id, class_id) "
+                                 "VALUES (:name, :student_id, :class_id)")) {
+        return fail("Failed to prepare student insert:", m_insertStudent.lastError().text());
+    }
+
+    return true;
+}
+
+bool StudentImporter::addBatch(const QVector<Student>& students) {
+    if (!m_active) {
+        return fail("Import not started", QString());
+    }
+
+    for (const Student& student : students) {
+        int classId = resolveClassId(student.className);
+        if (classId == -1) {
+            return false;
+        }
+
+        m_insertStudent.bindValue(":name", student.name);
+        m_insertStudent.bindValue(":student_id", student.studentId);
+        m_insertStudent.bindValue(":class_id", classId);
+
+        if (!m_insertStudent.exec()) {
+            return fail("Failed to import student " + student.studentId + ":",
+                        m_insertStudent.lastError().text());
+        }
+
+        // Photos go through the content-addressed store, spreadsheet rows
+        // normally carry none
+        if (!student.photoData.isEmpty() &&
+            !m_photoStore.assign(m_insertStudent.lastInsertId().toInt(), student.photoData)) {
+            return fail("Failed to import photo of " + student.studentId + ":",
+                        m_photoStore.getLastError());
+        }
+
+        // Only classes in the middle of a no-repeat cycle need the row id
+        auto bag = m_activeBags.find(classId);
+        if (bag == m_activeBags.end()) {
+            bag = m_activeBags.insert(classId, m_pickBag.size(classId) > 0);
+        }
+        if (bag.value()) {
+            m_pickBag.insert(classId, m_insertStudent.lastInsertId().toInt());
+        }
+
+        m_importedCount++;
+    }
+
+    return true;
+}
+
+bool StudentImporter::commit() {
+    if (!m_active) {
+        return false;
+    }
+
+    m_insertStudent.finish();
+    m_insertClass.finish();
+    m_active = false;
+
+    if (!m_database.commit()) {
+        fail("Failed to commit import:", m_database.lastError().text());
+        m_database.rollback();
+        return false;
+    }
+
+    Logger::info("Bulk import committed:", m_importedCount, "students");
+    return true;
+}
+
+void StudentImporter::rollback() {
+    if (!m_active) {
+        return;
+    }
+
+    m_insertStudent.finish();
+    m_insertClass.finish();
+    m_active = false;
+
+    m_database.rollback();
+    Logger::error("Bulk import rolled back");
+}
+
+int StudentImporter::importedCount() const {
+    return m_importedCount;
+}
+
+QString StudentImporter::getLastError() const {
+    return m_lastError;
+}
+
+int StudentImporter::resolveClassId(const QString& className) {
+    auto it = m_classIds.constFind(className);
+    if (it != m_classIds.constEnd()) {
+        return it.value();
+    }
+
+    m_insertClass.bindValue(":name", className);
+    if (!m_insertClass.exec()) {
+        fail("Failed to add class " + className + ":", m_insertClass.lastError().text());
+        return -1;
+    }
+
+    int classId = m_insertClass.lastInsertId().toInt();
+    m_classIds.insert(className, classId);
+
+    Logger::info("Class added: ", className);
+    return classId;
+}
+
+bool StudentImporter::fail(const QString& context, const QString& error) {
+    m_lastError = error.isEmpty() ? context : error;
+    Logger::error(context, error);
+    return false;
+}
+
+} // namespace StudentPicker
@@ -0,0 +1,57 @@
+#ifndef STUDENTIMPORTER_HPP
+#define STUDENTIMPORTER_HPP
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include "DatabaseManager.hpp"
+#include "PickBag.hpp"
+#include "PhotoStore.hpp"
+
+namespace StudentPicker {
+
+// Bulk insert path for imports. The INSERT statements are prepared once
+// and class names are resolved from a hash loaded once per import, so a
+// row costs one statement execution. Works on any open connection.
+class StudentImporter {
+public:
+    explicit StudentImporter(const QSqlDatabase& database);
+    ~StudentImporter();
+
+    // Start the transaction and prepare the statements
+    bool begin();
+
+    // Insert a batch of rows, can be called many times before commit()
+    bool addBatch(const QVector<Student>& students);
+
+    bool commit();
+    void rollback();
+
+    // Rows inserted since begin()
+    int importedCount() const;
+
+    QString getLastError() const;
+
+private:
+    // Class id by name, creates missing classes
+    int resolveClassId(const QString& className);
+
+    bool fail(const QString& context, const QString& error);
+
+    QSqlDatabase m_database;
+    QSqlQuery m_insertStudent;
+    QSqlQuery m_insertClass;
+    PickBag m_pickBag;
+    PhotoStore m_photoStore;
+    QHash<QString, int> m_classIds;
+    QHash<int, bool> m_activeBags;
+    int m_importedCount;
+    bool m_active;
+    QString m_lastError;
+};
+
+} // namespace StudentPicker
+
+#endif // STUDENTIMPORTER_HPP
@@ -0,0 +1,115 @@
+#include "StudentSearchIndex.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace StudentPicker {
+
+StudentSearchIndex::StudentSearchIndex() {
+}
+
+void StudentSearchIndex::build(const QVector<StudentSummary>& students) {
+    m_ids.clear();
+    m_classIds.clear();
+    m_keys.clear();
+    m_postings.clear();
+
+    m_ids.reserve(students.size());
+    m_classIds.reserve(students.size());
+    m_keys.reserve(students.size());
+
+    for (int position = 0; position < students.size(); position++) {
+        const StudentSummary& student = students[position];
+        QString name = normalize(student.name);
+        QString studentId = normalize(student.studentId);
+
+        // Trigrams per field, none of them spans the separator
+        addTrigrams(name, position);
+        addTrigrams(studentId, position);
+
+        m_ids.append(student.id);
+        m_classIds.append(student.classId);
+        m_keys.append(name + '\n' + studentId);
+    }
+}
+
+QVector<int> StudentSearchIndex::find(const QString& keyword, int classId) const {
+    QVector<int> results;
+    const QString needle = normalize(keyword);
+
+    if (needle.isEmpty()) {
+        return results;
+    }
+
+    auto accept = [&](int position) {
+        if ((classId == -1 || m_classIds[position] == classId) &&
+            m_keys[position].contains(needle)) {
+            results.append(m_ids[position]);
+        }
+    };
+
+    // One or two characters have no trigram, a plain scan of the folded
+    // keys is still well under a frame at 100k students
+    if (needle.size() < 3) {
+        for (int position = 0; position < m_keys.size(); position++) {
+            accept(position);
+        }
+        return results;
+    }
+
+    QVector<const QVector<int>*> lists;
+    for (int i = 0; i + 3 <= needle.size(); i++) {
+        auto it = m_postings.constFind(trigramKey(needle.constData() + i));
+        if (it == m_postings.constEnd()) {
+            return results;
+        }
+        lists.append(&it.value());
+    }
+
+    // Shortest list first keeps every intermediate result small
+    std::sort(lists.begin(), lists.end(),
+              [](const QVector<int>* a, const QVector<int>* b) {
+                  return a->size() < b->size();
+              });
+
+    QVector<int> candidates = *lists.first();
+    QVector<int> narrowed;
+    for (int i = 1; i < lists.size() && !candidates.isEmpty(); i++) {
+        narrowed.clear();
+        std::set_intersection(candidates.cbegin(), candidates.cend(),
+                              lists[i]->cbegin(), lists[i]->cend(),
+                              std::back_inserter(narrowed));
+        candidates.swap(narrowed);
+    }
+
+    // Sharing every trigram does not mean they are adjacent, check the text
+    for (int position : candidates) {
+        accept(position);
+    }
+    return results;
+}
+
+int StudentSearchIndex::size() const {
+    return m_ids.size();
+}
+
+QString StudentSearchIndex::normalize(const QString& text) {
+    return text.toCaseFolded();
+}
+
+quint64 StudentSearchIndex::trigramKey(const QChar* text) {
+    return (quint64(text[0].unicode()) << 32) |
+           (quint64(text[1].unicode()) << 16) |
+           quint64(text[2].unicode());
+}
+
+void StudentSearchIndex::addTrigrams(const QString& text, int position) {
+    for (int i = 0; i + 3 <= text.size(); i++) {
+        QVector<int>& list = m_postings[trigramKey(text.constData() + i)];
+        // Positions arrive in order, a repeated trigram is added once
+        if (list.isEmpty() || list.last() != position) {
+            list.append(position);
+        }
+    }
+}
+
+} // namespace StudentPicker
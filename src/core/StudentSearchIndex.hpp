@@ -0,0 +1,45 @@
+#ifndef STUDENTSEARCHINDEX_HPP
+#define STUDENTSEARCHINDEX_HPP
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include "DatabaseManager.hpp"
+
+namespace StudentPicker {
+
+// In-memory substring index over student names and StudentIDs. Each
+// case-folded trigram maps to the ascending positions of the students that
+// contain it, a query intersects the lists of its trigrams and checks the
+// few candidates left. Positions follow the order the students were given
+// in, so results come out in list order without sorting.
+// Built once and then only read, a finished index can be shared between
+// threads.
+class StudentSearchIndex {
+public:
+    StudentSearchIndex();
+
+    // Replace the contents with the given students, in display order
+    void build(const QVector<StudentSummary>& students);
+
+    // Row ids of the students whose name or StudentID contains keyword,
+    // case-insensitive, classId -1 = all classes
+    QVector<int> find(const QString& keyword, int classId = -1) const;
+
+    int size() const;
+
+private:
+    static QString normalize(const QString& text);
+    static quint64 trigramKey(const QChar* text);
+    void addTrigrams(const QString& text, int position);
+
+    QVector<int> m_ids;
+    QVector<int> m_classIds;
+    // Folded "name\nstudent_id", the separator never matches a keyword
+    QVector<QString> m_keys;
+    QHash<quint64, QVector<int>> m_postings;
+};
+
+} // namespace StudentPicker
+
+#endif // STUDENTSEARCHINDEX_HPP
@@ -1,10 +1,42 @@
 #include "XLSXReader.hpp"
+#include "ZipArchive.hpp"
 #include "logger.hpp"
+#include <QXmlStreamReader>
+#include <QHash>
 
 namespace StudentPicker {
 
+namespace {
+
+const QString WORKBOOK_PATH = "xl/workbook.xml";
+const QString WORKBOOK_RELS_PATH = "xl/_rels/workbook.xml.rels";
+const QString RELATIONSHIP_NS =
+    "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+
+// Target di workbook.xml.rels relatif ke folder xl/, kecuali diawali '/'
+QString resolveTarget(const QString& target) {
+    if (target.startsWith('/')) {
+        return target.mid(1);
+    }
+    return "xl/" + target;
+}
+
+// "BC12" -> 54 (index kolom mulai dari 0)
+int columnIndex(QStringView reference) {
+    int column = 0;
+    for (QChar c : reference) {
+        if (c < 'A' || c > 'Z') {
+            break;
+        }
+        column = column * 26 + (c.unicode() - 'A' + 1);
+    }
+    return column - 1;
+}
+
+} // namespace
+
 XLSXReader::XLSXReader() 
-    : m_sheetIndex(0) {
+    : m_sheetIndex(0), m_rowCount(0), m_skippedCount(0) {
 }
 
 XLSXReader::~XLSXReader() {
@@ -12,30 +44,349 @@ XLSXReader::~XLSXReader() {
 
 bool XLSXReader::readFile(const QString& filePath) {
     m_data.clear();
+    
+    return readFile(filePath, [this](const QVector<QVariantMap>& rows) {
+        m_data.append(rows);
+        return true;
+    });
+}
+
+bool XLSXReader::readFile(const QString& filePath, const RowConsumer& consumer, int batchSize) {
     m_headers.clear();
+    m_sharedStrings.clear();
     m_lastError.clear();
+    m_rowCount = 0;
+    m_skippedCount = 0;
+    
+    ZipArchive archive;
+    if (!archive.open(filePath)) {
+        m_lastError = archive.getLastError();
+        return false;
+    }
+    
+    QString sheetPath;
+    QString sharedStringsPath;
+    if (!resolveParts(archive, sheetPath, sharedStringsPath)) {
+        Logger::error(m_lastError);
+        return false;
+    }
+    
+    if (!sharedStringsPath.isEmpty() && !loadSharedStrings(archive, sharedStringsPath)) {
+        Logger::error(m_lastError);
+        return false;
+    }
+    
+    if (!readSheet(archive, sheetPath, consumer, batchSize)) {
+        return false;
+    }
+    
+    // Shared strings tidak dibutuhkan lagi setelah sheet selesai
+    m_sharedStrings.clear();
+    
+    Logger::info("XLSX file read successfully:", filePath, "sheet:", sheetPath);
+    Logger::info("Total rows:", m_rowCount);
+    
+    if (m_skippedCount > 0) {
+        Logger::warn("Skipped", m_skippedCount, "rows with values outside the header columns");
+    }
+    
+    return true;
+}
+
+bool XLSXReader::resolveParts(ZipArchive& archive, QString& sheetPath, QString& sharedStringsPath) {
+    if (!archive.contains(WORKBOOK_PATH)) {
+        m_lastError = "Invalid XLSX file: workbook not found";
+        return false;
+    }
+    
+    // Daftar sheet sesuai urutan di workbook
+    QStringList sheetNames;
+    QStringList sheetRelIds;
+    
+    QXmlStreamReader workbook(archive.readAll(WORKBOOK_PATH));
+    while (!workbook.atEnd()) {
+        if (workbook.readNext() == QXmlStreamReader::StartElement && workbook.name() == u"sheet") {
+            sheetNames.append(workbook.attributes().value("name").toString());
+            sheetRelIds.append(workbook.attributes().value(RELATIONSHIP_NS, "id").toString());
+        }
+    }
+    
+    if (workbook.hasError()) {
+        m_lastError = "Invalid XLSX workbook: " + workbook.errorString();
+        return false;
+    }
     
-    // IMPLEMENTASI SEMENTARA
-    // Karena Qt tidak memiliki built-in XLSX reader
+    int index = m_sheetIndex;
+    if (!m_sheetName.isEmpty()) {
+        index = sheetNames.indexOf(m_sheetName);
+        if (index == -1) {
+            m_lastError = "Sheet not found: " + m_sheetName;
+            return false;
+        }
+    }
     
-    // OPSI: Untuk implementasi lengkap, gunakan library QtXlsx
-    // Tambahkan di CMakeLists.txt:
-    // find_package(QXlsx REQUIRED)
-    // target_link_libraries(StudentPicker QXlsx::QXlsx)
+    if (index < 0 || index >= sheetNames.size()) {
+        m_lastError = QString("Sheet index %1 out of range (workbook has %2 sheets)")
+                          .arg(index).arg(sheetNames.size());
+        return false;
+    }
     
-    // Untuk saat ini, return error dan minta user convert ke CSV
-    m_lastError = "XLSX format is not yet fully supported.\n"
-                  "Please convert your file to CSV format.\n\n"
-                  "How to convert:\n"
-                  "1. Open your XLSX file in Excel/LibreOffice\n"
-                  "2. File > Save As\n"
-                  "3. Choose 'CSV (Comma delimited)' format\n"
-                  "4. Save and import the CSV file instead";
+    // Relationship id -> path part di dalam arsip
+    QHash<QString, QString> targets;
     
-    Logger::warn("XLSX file attempted but not supported:", filePath);
-    Logger::info("Please convert to CSV format");
+    QXmlStreamReader rels(archive.readAll(WORKBOOK_RELS_PATH));
+    while (!rels.atEnd()) {
+        if (rels.readNext() == QXmlStreamReader::StartElement && rels.name() == u"Relationship") {
+            const QXmlStreamAttributes attributes = rels.attributes();
+            const QString target = resolveTarget(attributes.value("Target").toString());
+            targets.insert(attributes.value("Id").toString(), target);
+            
+            if (attributes.value("Type").endsWith(u"/sharedStrings")) {
+                sharedStringsPath = target;
+            }
+        }
+    }
     
-    return false;
+    sheetPath = targets.value(sheetRelIds[index]);
+    if (sheetPath.isEmpty() || !archive.contains(sheetPath)) {
+        m_lastError = "Invalid XLSX file: sheet part not found for " + sheetNames[index];
+        return false;
+    }
+    
+    if (sharedStringsPath.isEmpty() && archive.contains("xl/sharedStrings.xml")) {
+        sharedStringsPath = "xl/sharedStrings.xml";
+    }
+    
+    return true;
+}
+
+bool XLSXReader::loadSharedStrings(ZipArchive& archive, const QString& path) {
+    QXmlStreamReader xml;
+    QString current;
+    bool inText = false;
+    bool inPhonetic = false;
+    bool xmlError = false;
+    
+    bool ok = archive.readEntry(path, [&](const QByteArray& chunk) {
+        xml.addData(chunk);
+        
+        while (true) {
+            const QXmlStreamReader::TokenType token = xml.readNext();
+            
+            if (token == QXmlStreamReader::Invalid) {
+                // Tag terpotong di akhir chunk, lanjut di chunk berikutnya
+                if (xml.error() == QXmlStreamReader::PrematureEndOfDocumentError) {
+                    return true;
+                }
+                xmlError = true;
+                return false;
+            }
+            
+            if (token == QXmlStreamReader::EndDocument) {
+                return true;
+            }
+            
+            if (token == QXmlStreamReader::StartElement) {
+                if (xml.name() == u"si") {
+                    current.clear();
+                } else if (xml.name() == u"rPh") {
+                    inPhonetic = true;
+                } else if (xml.name() == u"t") {
+                    inText = !inPhonetic;
+                }
+            } else if (token == QXmlStreamReader::Characters) {
+                if (inText) {
+                    current += xml.text();
+                }
+            } else if (token == QXmlStreamReader::EndElement) {
+                if (xml.name() == u"t") {
+                    inText = false;
+                } else if (xml.name() == u"rPh") {
+                    inPhonetic = false;
+                } else if (xml.name() == u"si") {
+                    m_sharedStrings.append(current);
+                }
+            }
+        }
+    });
+    
+    if (xmlError) {
+        m_lastError = "Invalid XLSX shared strings: " + xml.errorString();
+        return false;
+    }
+    
+    if (!ok) {
+        m_lastError = archive.getLastError();
+        return false;
+    }
+    
+    Logger::info("Loaded", m_sharedStrings.size(), "shared strings");
+    return true;
+}
+
+bool XLSXReader::readSheet(ZipArchive& archive, const QString& path,
+                           const RowConsumer& consumer, int batchSize) {
+    QXmlStreamReader xml;
+    
+    // Hanya satu batch yang ada di memory, ukuran sheet tidak berpengaruh
+    QVector<QVariantMap> batch;
+    batch.reserve(batchSize);
+    
+    QStringList cells;
+    QString cellType;
+    QString text;
+    int column = 0;
+    int nextColumn = 0;
+    bool inValue = false;
+    bool inPhonetic = false;
+    bool hasHeader = false;
+    bool xmlError = false;
+    bool stopped = false;
+    
+    // Return false jika consumer minta berhenti
+    auto finishRow = [&]() -> bool {
+        bool empty = true;
+        for (const QString& cell : cells) {
+            if (!cell.trimmed().isEmpty()) {
+                empty = false;
+                break;
+            }
+        }
+        
+        if (empty) {
+            return true;
+        }
+        
+        // Baris pertama yang berisi adalah header
+        if (!hasHeader) {
+            for (const QString& cell : cells) {
+                m_headers.append(cell.trimmed());
+            }
+            while (!m_headers.isEmpty() && m_headers.last().isEmpty()) {
+                m_headers.removeLast();
+            }
+            hasHeader = true;
+            Logger::info("XLSX Headers:", m_headers.join(", "));
+            return true;
+        }
+        
+        for (int i = m_headers.size(); i < cells.size(); i++) {
+            if (!cells[i].trimmed().isEmpty()) {
+                m_skippedCount++;
+                return true;
+            }
+        }
+        
+        QVariantMap row;
+        for (int i = 0; i < m_headers.size(); i++) {
+            row[m_headers[i]] = cells.value(i).trimmed();
+        }
+        
+        batch.append(row);
+        m_rowCount++;
+        
+        if (batch.size() >= batchSize) {
+            if (!consumer(batch)) {
+                return false;
+            }
+            batch.clear();
+        }
+        return true;
+    };
+    
+    bool ok = archive.readEntry(path, [&](const QByteArray& chunk) {
+        xml.addData(chunk);
+        
+        while (true) {
+            const QXmlStreamReader::TokenType token = xml.readNext();
+            
+            if (token == QXmlStreamReader::Invalid) {
+                // Tag terpotong di akhir chunk, lanjut di chunk berikutnya
+                if (xml.error() == QXmlStreamReader::PrematureEndOfDocumentError) {
+                    return true;
+                }
+                xmlError = true;
+                return false;
+            }
+            
+            if (token == QXmlStreamReader::EndDocument) {
+                return true;
+            }
+            
+            if (token == QXmlStreamReader::StartElement) {
+                const QStringView name = xml.name();
+                if (name == u"row") {
+                    cells.clear();
+                    nextColumn = 0;
+                } else if (name == u"c") {
+                    const QXmlStreamAttributes attributes = xml.attributes();
+                    cellType = attributes.value("t").toString();
+                    const QStringView reference = attributes.value("r");
+                    column = reference.isEmpty() ? nextColumn : columnIndex(reference);
+                    text.clear();
+                } else if (name == u"rPh") {
+                    inPhonetic = true;
+                } else if (name == u"v" || name == u"t") {
+                    inValue = !inPhonetic;
+                }
+            } else if (token == QXmlStreamReader::Characters) {
+                if (inValue) {
+                    text += xml.text();
+                }
+            } else if (token == QXmlStreamReader::EndElement) {
+                const QStringView name = xml.name();
+                if (name == u"v" || name == u"t") {
+                    inValue = false;
+                } else if (name == u"rPh") {
+                    inPhonetic = false;
+                } else if (name == u"c") {
+                    QString value = text;
+                    if (cellType == "s") {
+                        value = m_sharedStrings.value(text.toInt());
+                    } else if (cellType == "b") {
+                        value = text == "1" ? "TRUE" : "FALSE";
+                    }
+                    
+                    if (column < 0) {
+                        column = nextColumn;
+                    }
+                    while (cells.size() <= column) {
+                        cells.append(QString());
+                    }
+                    cells[column] = value;
+                    nextColumn = column + 1;
+                } else if (name == u"row") {
+                    if (!finishRow()) {
+                        stopped = true;
+                        return false;
+                    }
+                }
+            }
+        }
+    });
+    
+    if (stopped) {
+        Logger::warn("XLSX reading stopped by consumer");
+        return false;
+    }
+    
+    if (xmlError) {
+        m_lastError = "Invalid XLSX sheet: " + xml.errorString();
+        Logger::error(m_lastError);
+        return false;
+    }
+    
+    if (!ok) {
+        m_lastError = archive.getLastError();
+        return false;
+    }
+    
+    if (!batch.isEmpty() && !consumer(batch)) {
+        Logger::warn("XLSX reading stopped by consumer");
+        return false;
+    }
+    
+    return true;
 }
 
 QVector<QVariantMap> XLSXReader::getData() const {
@@ -46,6 +397,14 @@ QStringList XLSXReader::getHeaders() const {
     return m_headers;
 }
 
+int XLSXReader::getRowCount() const {
+    return m_rowCount;
+}
+
+int XLSXReader::getSkippedCount() const {
+    return m_skippedCount;
+}
+
 QString XLSXReader::getLastError() const {
     return m_lastError;
 }
@@ -58,4 +417,4 @@ void XLSXReader::setSheetIndex(int index) {
     m_sheetIndex = index;
 }
 
-} // namespace StudentPicker
\ No newline at end of file
+} // namespace StudentPicker
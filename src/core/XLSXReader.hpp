@@ -2,25 +2,45 @@
 #define XLSXREADER_HPP
 
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include <QVariantMap>
+#include <functional>
 
 namespace StudentPicker {
 
+class ZipArchive;
+
 class XLSXReader {
 public:
+    // Terima satu batch baris, return false untuk berhenti membaca
+    using RowConsumer = std::function<bool(const QVector<QVariantMap>& rows)>;
+    
+    static const int DEFAULT_BATCH_SIZE = 1000;
+    
     XLSXReader();
     ~XLSXReader();
     
     // Baca file XLSX
     bool readFile(const QString& filePath);
     
+    // Baca sheet secara streaming (inflate + XML per chunk), baris dikirim
+    // per batch ke consumer. Baris pertama sheet dipakai sebagai header.
+    bool readFile(const QString& filePath, const RowConsumer& consumer,
+                  int batchSize = DEFAULT_BATCH_SIZE);
+    
     // Get data yang sudah dibaca
     QVector<QVariantMap> getData() const;
     
     // Get headers
     QStringList getHeaders() const;
     
+    // Jumlah baris data yang sudah dibaca
+    int getRowCount() const;
+    
+    // Jumlah baris yang dilewati karena punya nilai di kolom tanpa header
+    int getSkippedCount() const;
+    
     // Get error message
     QString getLastError() const;
     
@@ -31,13 +51,26 @@ public:
     void setSheetIndex(int index);
     
 private:
+    // Cari path sheet yang dipilih dan path sharedStrings dari workbook
+    bool resolveParts(ZipArchive& archive, QString& sheetPath, QString& sharedStringsPath);
+    
+    // Baca tabel shared strings (satu-satunya bagian yang disimpan utuh)
+    bool loadSharedStrings(ZipArchive& archive, const QString& path);
+    
+    // Stream sheet dan kirim baris ke consumer
+    bool readSheet(ZipArchive& archive, const QString& path,
+                   const RowConsumer& consumer, int batchSize);
+    
     QVector<QVariantMap> m_data;
     QStringList m_headers;
+    QStringList m_sharedStrings;
     QString m_lastError;
     QString m_sheetName;
     int m_sheetIndex;
+    int m_rowCount;
+    int m_skippedCount;
 };
 
 } // namespace StudentPicker
 
-#endif // XLSXREADER_HPP
\ No newline at end of file
+#endif // XLSXREADER_HPP
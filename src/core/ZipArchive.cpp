@@ -0,0 +1,254 @@
+#include "ZipArchive.hpp"
+#include "logger.hpp"
+#include <QtEndian>
+#include <zlib.h>
+
+namespace StudentPicker {
+
+namespace {
+
+const quint32 LOCAL_HEADER_SIGNATURE = 0x04034b50;
+const quint32 CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+const quint32 END_OF_CENTRAL_DIR_SIGNATURE = 0x06054b50;
+
+const int LOCAL_HEADER_SIZE = 30;
+const int CENTRAL_HEADER_SIZE = 46;
+const int END_OF_CENTRAL_DIR_SIZE = 22;
+const int MAX_COMMENT_SIZE = 0xFFFF;
+
+const quint16 METHOD_STORED = 0;
+const quint16 METHOD_DEFLATE = 8;
+
+// readAll memuat entry utuh ke memory. Ukuran di header tidak dipercaya:
+// reserve dibatasi, dan entry yang lebih besar dari batas ditolak.
+const qsizetype MAX_RESERVE_SIZE = 64 * 1024 * 1024;
+const qsizetype MAX_READALL_SIZE = 256 * 1024 * 1024;
+
+inline quint16 read16(const char* p) {
+    return qFromLittleEndian<quint16>(p);
+}
+
+inline quint32 read32(const char* p) {
+    return qFromLittleEndian<quint32>(p);
+}
+
+} // namespace
+
+ZipArchive::ZipArchive() {
+}
+
+ZipArchive::~ZipArchive() {
+    close();
+}
+
+bool ZipArchive::open(const QString& filePath) {
+    close();
+    m_lastError.clear();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail("Cannot open file: " + filePath);
+    }
+
+    return readCentralDirectory();
+}
+
+void ZipArchive::close() {
+    m_entries.clear();
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool ZipArchive::contains(const QString& name) const {
+    return m_entries.contains(name);
+}
+
+bool ZipArchive::readCentralDirectory() {
+    // End of central directory ada di akhir file, setelah komentar opsional
+    const qint64 fileSize = m_file.size();
+    const qint64 tailSize = qMin<qint64>(fileSize, END_OF_CENTRAL_DIR_SIZE + MAX_COMMENT_SIZE);
+
+    m_file.seek(fileSize - tailSize);
+    const QByteArray tail = m_file.read(tailSize);
+
+    qsizetype eocd = -1;
+    for (qsizetype i = tail.size() - END_OF_CENTRAL_DIR_SIZE; i >= 0; i--) {
+        if (read32(tail.constData() + i) == END_OF_CENTRAL_DIR_SIGNATURE) {
+            eocd = i;
+            break;
+        }
+    }
+
+    if (eocd < 0) {
+        return fail("Not a ZIP archive");
+    }
+
+    const char* record = tail.constData() + eocd;
+    const quint16 entryCount = read16(record + 10);
+    const quint32 directorySize = read32(record + 12);
+    const quint32 directoryOffset = read32(record + 16);
+
+    if (directoryOffset == 0xFFFFFFFF || entryCount == 0xFFFF) {
+        return fail("ZIP64 archives are not supported");
+    }
+
+    m_file.seek(directoryOffset);
+    const QByteArray directory = m_file.read(directorySize);
+    if (directory.size() != qsizetype(directorySize)) {
+        return fail("Truncated ZIP central directory");
+    }
+
+    qsizetype pos = 0;
+    for (int i = 0; i < entryCount; i++) {
+        if (pos + CENTRAL_HEADER_SIZE > directory.size()
+            || read32(directory.constData() + pos) != CENTRAL_HEADER_SIGNATURE) {
+            return fail("Corrupt ZIP central directory");
+        }
+
+        const char* header = directory.constData() + pos;
+        const quint16 nameLength = read16(header + 28);
+        const quint16 extraLength = read16(header + 30);
+        const quint16 commentLength = read16(header + 32);
+
+        Entry entry;
+        entry.method = read16(header + 10);
+        entry.compressedSize = read32(header + 20);
+        entry.uncompressedSize = read32(header + 24);
+        entry.localHeaderOffset = read32(header + 42);
+
+        const QString name = QString::fromUtf8(header + CENTRAL_HEADER_SIZE, nameLength);
+        m_entries.insert(name, entry);
+
+        pos += CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+    }
+
+    Logger::info("ZIP archive opened with", m_entries.size(), "entries");
+    return true;
+}
+
+bool ZipArchive::readEntry(const QString& name, const ChunkConsumer& consumer) {
+    auto it = m_entries.constFind(name);
+    if (it == m_entries.constEnd()) {
+        return fail("Entry not found in archive: " + name);
+    }
+    const Entry entry = it.value();
+
+    // Ukuran nama/extra di local header bisa beda dari central directory
+    m_file.seek(entry.localHeaderOffset);
+    const QByteArray localHeader = m_file.read(LOCAL_HEADER_SIZE);
+    if (localHeader.size() != LOCAL_HEADER_SIZE
+        || read32(localHeader.constData()) != LOCAL_HEADER_SIGNATURE) {
+        return fail("Corrupt ZIP local header: " + name);
+    }
+
+    const qint64 dataOffset = qint64(entry.localHeaderOffset) + LOCAL_HEADER_SIZE
+        + read16(localHeader.constData() + 26) + read16(localHeader.constData() + 28);
+    m_file.seek(dataOffset);
+
+    QByteArray input(CHUNK_SIZE, Qt::Uninitialized);
+    qint64 remaining = entry.compressedSize;
+
+    if (entry.method == METHOD_STORED) {
+        while (remaining > 0) {
+            const qint64 bytesRead = m_file.read(input.data(), qMin<qint64>(CHUNK_SIZE, remaining));
+            if (bytesRead <= 0) {
+                return fail("Truncated ZIP entry: " + name);
+            }
+            remaining -= bytesRead;
+            if (!consumer(QByteArray::fromRawData(input.constData(), bytesRead))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (entry.method != METHOD_DEFLATE) {
+        return fail("Unsupported ZIP compression method for " + name);
+    }
+
+    // Raw deflate tanpa header zlib
+    z_stream stream = {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return fail("Failed to initialize inflate");
+    }
+
+    QByteArray output(CHUNK_SIZE, Qt::Uninitialized);
+    int status = Z_OK;
+
+    while (status != Z_STREAM_END) {
+        if (stream.avail_in == 0) {
+            if (remaining == 0) {
+                inflateEnd(&stream);
+                return fail("Truncated ZIP entry: " + name);
+            }
+            const qint64 bytesRead = m_file.read(input.data(), qMin<qint64>(CHUNK_SIZE, remaining));
+            if (bytesRead <= 0) {
+                inflateEnd(&stream);
+                return fail("Truncated ZIP entry: " + name);
+            }
+            remaining -= bytesRead;
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = uInt(bytesRead);
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = CHUNK_SIZE;
+
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            inflateEnd(&stream);
+            return fail("Corrupt deflate data in " + name);
+        }
+
+        const qsizetype produced = CHUNK_SIZE - stream.avail_out;
+        if (produced > 0 && !consumer(QByteArray::fromRawData(output.constData(), produced))) {
+            inflateEnd(&stream);
+            return false;
+        }
+    }
+
+    inflateEnd(&stream);
+    return true;
+}
+
+QByteArray ZipArchive::readAll(const QString& name) {
+    QByteArray data;
+    auto it = m_entries.constFind(name);
+    if (it != m_entries.constEnd()) {
+        if (qsizetype(it.value().uncompressedSize) > MAX_READALL_SIZE) {
+            fail("ZIP entry too large: " + name);
+            return QByteArray();
+        }
+        data.reserve(qMin(qsizetype(it.value().uncompressedSize), MAX_RESERVE_SIZE));
+    }
+
+    // Header bisa bohong, hasil inflate tetap dibatasi
+    bool tooLarge = false;
+    bool ok = readEntry(name, [&data, &tooLarge](const QByteArray& chunk) {
+        if (data.size() + chunk.size() > MAX_READALL_SIZE) {
+            tooLarge = true;
+            return false;
+        }
+        data.append(chunk);
+        return true;
+    });
+
+    if (tooLarge) {
+        fail("ZIP entry too large: " + name);
+    }
+
+    return ok ? data : QByteArray();
+}
+
+QString ZipArchive::getLastError() const {
+    return m_lastError;
+}
+
+bool ZipArchive::fail(const QString& error) {
+    m_lastError = error;
+    Logger::error(m_lastError);
+    return false;
+}
+
+} // namespace StudentPicker
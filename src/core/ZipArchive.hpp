@@ -0,0 +1,60 @@
+#ifndef ZIPARCHIVE_HPP
+#define ZIPARCHIVE_HPP
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <functional>
+
+namespace StudentPicker {
+
+// Pembaca ZIP minimal untuk file XLSX. Hanya membaca central directory,
+// isi entry di-inflate per chunk sehingga entry besar tidak pernah
+// dimuat utuh ke memory. Mendukung metode stored dan deflate (tanpa ZIP64).
+class ZipArchive {
+public:
+    // Terima satu chunk hasil dekompresi, return false untuk berhenti.
+    // Chunk hanya valid selama callback berjalan.
+    using ChunkConsumer = std::function<bool(const QByteArray& chunk)>;
+
+    static const int CHUNK_SIZE = 64 * 1024;
+
+    ZipArchive();
+    ~ZipArchive();
+
+    // Buka file dan baca central directory
+    bool open(const QString& filePath);
+    void close();
+
+    // Cek apakah entry ada di arsip
+    bool contains(const QString& name) const;
+
+    // Baca entry secara streaming
+    bool readEntry(const QString& name, const ChunkConsumer& consumer);
+
+    // Baca seluruh entry (untuk entry kecil seperti workbook.xml)
+    QByteArray readAll(const QString& name);
+
+    // Get error message
+    QString getLastError() const;
+
+private:
+    struct Entry {
+        quint16 method;
+        quint32 compressedSize;
+        quint32 uncompressedSize;
+        quint32 localHeaderOffset;
+    };
+
+    bool readCentralDirectory();
+    bool fail(const QString& error);
+
+    QFile m_file;
+    QHash<QString, Entry> m_entries;
+    QString m_lastError;
+};
+
+} // namespace StudentPicker
+
+#endif // ZIPARCHIVE_HPP
@@ -44,10 +44,21 @@ namespace GlobalConf {
     const int MAX_IMAGE_SIZE_KB = 300; // in kilobytes
     const int MIN_IMAGE_SIZE_KB = 100; // in kilobytes
 
+    // Longest side of a stored photo, larger images are decoded smaller
+    const int MAX_PHOTO_DIMENSION = 1200; // in pixels
+
     // GUI window size when presenting the image
     const int DISPLAY_IMAGE_WIDTH = 300;
     const int DISPLAY_IMAGE_HEIGHT = 400;
 
+    // Square box of the small list thumbnail
+    const int LIST_THUMBNAIL_SIZE = 64;
+
+    // SQLite tuning of the "performance" database profile
+    const int DB_CACHE_SIZE_KB = 16384;                 // page cache per connection
+    const qint64 DB_MMAP_SIZE = 256LL * 1024 * 1024;    // in bytes
+    const int DB_WAL_AUTOCHECKPOINT = 1000;             // in pages
+
 }
 }
 
@@ -10,6 +10,8 @@ const QString UserConfig::KEY_LAST_DATABASE_PATH = "database/lastPath";
 const QString UserConfig::KEY_LAST_IMPORT_PATH = "import/lastPath";
 const QString UserConfig::KEY_WINDOW_GEOMETRY = "window/geometry";
 const QString UserConfig::KEY_WINDOW_STATE = "window/state";
+const QString UserConfig::KEY_FAIR_PICK = "selection/fairPick";
+const QString UserConfig::KEY_DATABASE_PROFILE = "database/profile";
 
 UserConfig::UserConfig(){
     QString configPath = GlobalConf::getConfigPath();
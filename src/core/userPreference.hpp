@@ -36,6 +36,8 @@ public:
     static const QString KEY_WINDOW_GEOMETRY;
     static const QString KEY_WINDOW_STATE;
     static const QString KEY_LAST_SELECTED_CLASS;
+    static const QString KEY_FAIR_PICK;
+    static const QString KEY_DATABASE_PROFILE;
 
 private:
     UserConfig();
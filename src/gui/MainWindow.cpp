@@ -4,6 +4,9 @@
 #include "../core/CSVReader.hpp"
 #include "../core/XLSXReader.hpp"
 #include "../core/ImageProcessor.hpp"
+#include "../core/ImportPipeline.hpp"
+#include "../core/PhotoImportPipeline.hpp"
+#include "../core/DatabaseWorker.hpp"
 #include "../core/global.hpp"
 
 #include <QMenuBar>
@@ -16,18 +19,24 @@
 #include <QApplication>
 #include <QStatusBar>
 #include <QCloseEvent>
+#include <QtConcurrent>
 
 namespace StudentPicker {
 
 // ==================== CONSTRUCTOR ====================
 
 MainWindow::MainWindow(QWidget* parent)
-    : QMainWindow(parent), m_selectedStudentId(-1) {
+    : QMainWindow(parent), m_selectedStudentId(-1), m_shownPhotoVersion(-1) {
     
-    if (!DatabaseManager::instance().initDb()) {
+    // The connection is opened on the database thread and stays there
+    DatabaseWorker::instance().start();
+    QString initError = DatabaseWorker::instance().runSync([](DatabaseManager& db) {
+        return db.initDb() ? QString() : db.getLastError();
+    });
+    
+    if (!initError.isEmpty()) {
         QMessageBox::critical(this, "Error", 
-            "Failed to initialize database: " + 
-            DatabaseManager::instance().getLastError());
+            "Failed to initialize database: " + initError);
         QApplication::quit();
         return;
     }
@@ -37,6 +46,8 @@ MainWindow::MainWindow(QWidget* parent)
     applyStyles();
     restoreWindowState();
     loadClasses();
+    m_studentSearch->rebuild();
+    backfillThumbnails();
     
     Logger::info("MainWindow initialized");
 }
@@ -75,6 +86,26 @@ void MainWindow::setupUI() {
     m_pickRandomButton->setEnabled(false);
     connect(m_pickRandomButton, &QPushButton::clicked, this, &MainWindow::onPickRandomClicked);
     
+    m_fairPickCheckBox = new QCheckBox("No repeats", this);
+    m_fairPickCheckBox->setToolTip("Call everyone in the class once before anyone is picked again");
+    m_fairPickCheckBox->setChecked(
+        UserConfig::instance().getValue(UserConfig::KEY_FAIR_PICK, false).toBool());
+    connect(m_fairPickCheckBox, &QCheckBox::toggled, [](bool checked) {
+        UserConfig::instance().setValue(UserConfig::KEY_FAIR_PICK, checked);
+    });
+    
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setMinimumHeight(40);
+    m_searchEdit->setMinimumWidth(220);
+    m_searchEdit->setPlaceholderText("🔍 Search name or Student ID");
+    m_searchEdit->setClearButtonEnabled(true);
+    
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(SEARCH_DEBOUNCE_MS);
+    connect(m_searchEdit, &QLineEdit::textChanged, m_searchTimer, QOverload<>::of(&QTimer::start));
+    connect(m_searchTimer, &QTimer::timeout, this, &MainWindow::runSearch);
+    
     m_refreshButton = new QPushButton("🔄 Refresh", this);
     m_refreshButton->setMinimumHeight(40);
     connect(m_refreshButton, &QPushButton::clicked, this, &MainWindow::onRefreshClicked);
@@ -83,7 +114,9 @@ void MainWindow::setupUI() {
     m_topLayout->addWidget(new QLabel("Class:", this));
     m_topLayout->addWidget(m_classComboBox);
     m_topLayout->addWidget(m_pickRandomButton);
+    m_topLayout->addWidget(m_fairPickCheckBox);
     m_topLayout->addStretch();
+    m_topLayout->addWidget(m_searchEdit);
     m_topLayout->addWidget(m_refreshButton);
     
     m_mainLayout->addLayout(m_topLayout);
@@ -99,6 +132,11 @@ void MainWindow::setupUI() {
     m_tableView->verticalHeader()->setVisible(false);
     m_tableView->setMinimumHeight(300);
     
+    // Rows fit the list thumbnail in the photo column
+    const int listSize = GlobalConf::LIST_THUMBNAIL_SIZE;
+    m_tableView->setIconSize(QSize(listSize, listSize));
+    m_tableView->verticalHeader()->setDefaultSectionSize(listSize + 8);
+    
     m_tableView->setColumnWidth(0, 50);
     m_tableView->setColumnWidth(1, 200);
     m_tableView->setColumnWidth(2, 150);
@@ -107,6 +145,22 @@ void MainWindow::setupUI() {
     
     connect(m_tableView->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &MainWindow::onTableSelectionChanged);
+    connect(m_tableModel, &StudentTableModel::studentCountChanged,
+            this, &MainWindow::onStudentCountChanged);
+    
+    m_thumbnailLoader = new ThumbnailLoader(this);
+    connect(m_thumbnailLoader, &ThumbnailLoader::thumbnailReady,
+            this, &MainWindow::onThumbnailReady);
+    m_tableModel->setThumbnailLoader(m_thumbnailLoader);
+    
+    m_studentSearch = new StudentSearch(this);
+    connect(m_studentSearch, &StudentSearch::resultsReady,
+            m_tableModel, &StudentTableModel::setSearchResults);
+    connect(m_studentSearch, &StudentSearch::indexRebuilt, this, [this]() {
+        if (m_tableModel->isSearching()) {
+            runSearch();
+        }
+    });
     
     m_mainLayout->addWidget(m_tableView, 2);
     
@@ -170,8 +224,11 @@ void MainWindow::setupMenuBar() {
     
     QMenu* fileMenu = menuBar->addMenu("&File");
     
-    QAction* importAction = fileMenu->addAction("📥 Import Data");
-    connect(importAction, &QAction::triggered, this, &MainWindow::onImportClicked);
+    m_importAction = fileMenu->addAction("📥 Import Data");
+    connect(m_importAction, &QAction::triggered, this, &MainWindow::onImportClicked);
+    
+    m_importPhotosAction = fileMenu->addAction("🖼️ Import Photos from Folder");
+    connect(m_importPhotosAction, &QAction::triggered, this, &MainWindow::onImportPhotosClicked);
     
     fileMenu->addSeparator();
     
@@ -242,6 +299,18 @@ void MainWindow::applyStyles() {
             border-color: #4CAF50;
         }
         
+        QLineEdit {
+            background-color: #f5f5f5;
+            border: 2px solid #e0e0e0;
+            border-radius: 5px;
+            padding: 8px;
+            font-size: 14px;
+        }
+        
+        QLineEdit:focus {
+            border-color: #4CAF50;
+        }
+        
         QTableView {
             background-color: #ffffff;
             alternate-background-color: #f9f9f9;
@@ -297,43 +366,59 @@ void MainWindow::loadClasses() {
     m_classComboBox->clear();
     m_classComboBox->addItem("All Classes", -1);
     
-    m_classes = DatabaseManager::instance().getAllClasses();
-    
-    for (const QVariantMap& classData : m_classes) {
-        QString className = classData["name"].toString();
-        int classId = classData["id"].toInt();
-        m_classComboBox->addItem(className, classId);
-    }
-    
-    Logger::info("Loaded", m_classes.size(), "classes");
+    DatabaseWorker::instance()
+        .run([](DatabaseManager& db) {
+            return db.getAllClasses();
+        })
+        .then(this, [this](const QVector<QVariantMap>& classes) {
+            // A newer load may have filled the list in the meantime
+            while (m_classComboBox->count() > 1) {
+                m_classComboBox->removeItem(m_classComboBox->count() - 1);
+            }
+            
+            m_classes = classes;
+            for (const QVariantMap& classData : m_classes) {
+                QString className = classData["name"].toString();
+                int classId = classData["id"].toInt();
+                m_classComboBox->addItem(className, classId);
+            }
+            
+            Logger::info("Loaded", m_classes.size(), "classes");
+        });
 }
 
 void MainWindow::loadStudents() {
-    QVector<Student> students = DatabaseManager::instance().getAllStudents();
-    m_tableModel->setStudents(students);
-    
-    m_statusLabel->setText(QString("Total: %1 students").arg(students.size()));
-    Logger::info("Loaded", students.size(), "students");
+    m_tableModel->setClassFilter(-1);
 }
 
 void MainWindow::loadStudentsByClass(const QString& className) {
-    QVector<Student> students;
+    int index = m_classComboBox->findText(className);
+    int classId = index >= 0 ? m_classComboBox->itemData(index).toInt() : -1;
     
-    if (className == "All Classes") {
-        students = DatabaseManager::instance().getAllStudents();
+    m_tableModel->setClassFilter(classId);
+}
+
+void MainWindow::onStudentCountChanged(int count) {
+    QString className = m_classComboBox->currentText();
+    
+    if (m_tableModel->isSearching()) {
+        m_statusLabel->setText(QString("Found %1 students matching \"%2\"")
+                              .arg(count)
+                              .arg(m_searchEdit->text().trimmed()));
+    } else if (m_tableModel->classFilter() == -1) {
+        m_statusLabel->setText(QString("Total: %1 students").arg(count));
     } else {
-        students = DatabaseManager::instance().getStudentsByClassName(className);
+        m_statusLabel->setText(QString("Showing %1 students from %2")
+                              .arg(count)
+                              .arg(className));
     }
     
-    m_tableModel->setStudents(students);
-    
-    m_statusLabel->setText(QString("Showing %1 students from %2")
-                          .arg(students.size())
-                          .arg(className));
+    // The pick draws from the whole class, a search without hits does not
+    // make the class empty
+    m_pickRandomButton->setEnabled(m_tableModel->classFilter() != -1 &&
+                                   (count > 0 || m_tableModel->isSearching()));
     
-    m_pickRandomButton->setEnabled(!students.isEmpty() && className != "All Classes");
-    
-    Logger::info("Loaded", students.size(), "students from class:", className);
+    Logger::info("Loaded", count, "students from class:", className);
 }
 
 void MainWindow::displaySelectedStudent() {
@@ -347,67 +432,196 @@ void MainWindow::displaySelectedStudent() {
         return;
     }
     
-    Student student = DatabaseManager::instance().getStudentId(m_selectedStudentId);
-    
-    if (student.id == -1) {
-        Logger::warn("Student not found:", m_selectedStudentId);
-        return;
+    // The table already holds the summary of a visible row
+    int row = m_tableModel->rowForId(m_selectedStudentId);
+    if (row != -1) {
+        showStudent(m_tableModel->getStudent(row));
+    } else {
+        loadSelectedStudent();
     }
-    
+}
+
+void MainWindow::loadSelectedStudent() {
+    const int studentId = m_selectedStudentId;
+    
+    DatabaseWorker::instance()
+        .run([studentId](DatabaseManager& db) {
+            return db.getStudentSummaryId(studentId);
+        })
+        .then(this, [this, studentId](const StudentSummary& student) {
+            // The selection moved on while this student was loading
+            if (studentId != m_selectedStudentId) {
+                return;
+            }
+            
+            if (student.id == -1) {
+                Logger::warn("Student not found:", studentId);
+                return;
+            }
+            
+            showStudent(student);
+        });
+}
+
+void MainWindow::showStudent(const StudentSummary& student) {
     m_nameLabel->setText("Name: " + student.name);
     m_studentIdLabel->setText("Student ID: " + student.studentId);
     m_classLabel->setText("Class: " + student.className);
+    m_uploadPhotoButton->setEnabled(true);
+    m_shownPhotoVersion = student.photoVersion;
     
-    if (student.photoData.isEmpty()) {
+    if (!student.hasPhoto) {
         m_photoLabel->setText("No Photo Available");
         m_photoLabel->setPixmap(QPixmap());
-    } else {
-        QPixmap pixmap = ImageProcessor::pixmapFromData(
-            student.photoData, 
-            GlobalConf::DISPLAY_IMAGE_WIDTH, 
-            GlobalConf::DISPLAY_IMAGE_HEIGHT
-        );
-        m_photoLabel->setPixmap(pixmap);
+        return;
     }
     
-    m_uploadPhotoButton->setEnabled(true);
+    const QSize displaySize(GlobalConf::DISPLAY_IMAGE_WIDTH, GlobalConf::DISPLAY_IMAGE_HEIGHT);
+    QPixmap pixmap = m_thumbnailLoader->cached(student.id, student.photoVersion, displaySize);
     
-    Logger::info("Displaying student:", student.name);
+    if (!pixmap.isNull()) {
+        m_photoLabel->setPixmap(pixmap);
+    } else {
+        // Decoded in the background, onThumbnailReady fills the label
+        m_photoLabel->setPixmap(QPixmap());
+        m_photoLabel->setText("Loading...");
+        m_thumbnailLoader->request(student.id, student.photoVersion, displaySize);
+    }
 }
 
-void MainWindow::importCSV(const QString& filePath) {
-    CSVReader reader;
-    
-    if (!reader.readFile(filePath)) {
-        QMessageBox::critical(this, "Import Error", 
-            "Failed to read CSV file:\n" + reader.getLastError());
+void MainWindow::onThumbnailReady(int studentId, int photoVersion, const QSize& size,
+                                  const QPixmap& pixmap) {
+    // List thumbnails go to the table
+    if (size != QSize(GlobalConf::DISPLAY_IMAGE_WIDTH, GlobalConf::DISPLAY_IMAGE_HEIGHT)) {
         return;
     }
     
-    QVector<QVariantMap> data = reader.getData();
-    QStringList headers = reader.getHeaders();
-    
-    if (!headers.contains("Name") || !headers.contains("StudentID") || !headers.contains("Class")) {
-        QMessageBox::warning(this, "Import Warning",
-            "CSV file must contain columns: Name, StudentID, Class\n\n"
-            "Found columns: " + headers.join(", "));
+    // A photo replaced while decoding gets a request of its own
+    if (studentId != m_selectedStudentId || photoVersion != m_shownPhotoVersion) {
         return;
     }
     
-    QVector<Student> students;
-    for (const QVariantMap& row : data) {
-        Student student;
-        student.name = row["Name"].toString();
-        student.studentId = row["StudentID"].toString();
-        student.className = row["Class"].toString();
-        student.photoData = QByteArray();
+    if (pixmap.isNull()) {
+        m_photoLabel->setText("No Photo Available");
+        m_photoLabel->setPixmap(QPixmap());
+    } else {
+        m_photoLabel->setPixmap(pixmap);
+    }
+}
+
+template<typename Reader>
+MainWindow::ImportOutcome MainWindow::importRows(DatabaseManager& db, Reader& reader,
+                                                 const QString& filePath, const QString& format) {
+    ImportOutcome outcome;
+    
+    if (!db.beginImport()) {
+        outcome.message = "Failed to import students:\n" + db.getLastError();
+        return outcome;
+    }
+    
+    bool importFailed = false;
+    
+    // Rows are streamed straight into the import transaction batch by batch,
+    // the file is never held in memory as a whole
+    bool readOk = reader.readFile(filePath, [&](const QVector<QVariantMap>& rows) {
+        if (!ImportPipeline::hasRequiredColumns(reader.getHeaders())) {
+            return false;
+        }
         
-        students.append(student);
+        if (!db.importStudentsBatch(ImportPipeline::toStudents(rows))) {
+            importFailed = true;
+            return false;
+        }
+        return true;
+    });
+    
+    if (!reader.getHeaders().isEmpty() && !ImportPipeline::hasRequiredColumns(reader.getHeaders())) {
+        db.finishImport(false);
+        outcome.status = ImportOutcome::Warning;
+        outcome.message = format + " file must contain columns: Name, StudentID, Class\n\n"
+                          "Found columns: " + reader.getHeaders().join(", ");
+        return outcome;
+    }
+    
+    if (!readOk && !importFailed) {
+        db.finishImport(false);
+        outcome.message = "Failed to read " + format + " file:\n" + reader.getLastError();
+        return outcome;
     }
     
-    if (DatabaseManager::instance().importStudentsFile(students)) {
-        QMessageBox::information(this, "Import Success",
-            QString("Successfully imported %1 students!").arg(students.size()));
+    if (importFailed || !db.finishImport(true)) {
+        QString error = db.getLastError();
+        db.finishImport(false);
+        outcome.message = "Failed to import students:\n" + error;
+        return outcome;
+    }
+    
+    outcome.status = ImportOutcome::Success;
+    outcome.message = QString("Successfully imported %1 students!").arg(reader.getRowCount());
+    if (reader.getSkippedCount() > 0) {
+        outcome.message += QString("\n\n%1 malformed rows were skipped.").arg(reader.getSkippedCount());
+    }
+    return outcome;
+}
+
+void MainWindow::importFile(const QString& filePath, const QString& format) {
+    setImportRunning(true);
+    
+    // Parsing and inserting both happen on the database thread
+    DatabaseWorker::instance()
+        .run([filePath, format](DatabaseManager& db) {
+            if (format == "XLSX") {
+                XLSXReader reader;
+                return importRows(db, reader, filePath, format);
+            }
+            CSVReader reader;
+            return importRows(db, reader, filePath, format);
+        })
+        .then(this, [this, filePath](const ImportOutcome& outcome) {
+            onImportFinished(outcome, filePath);
+        });
+}
+
+void MainWindow::importFiles(const QStringList& filePaths) {
+    setImportRunning(true);
+    
+    // Files are parsed in parallel, one writer inserts them in one transaction
+    // on its own connection. The pipeline is driven from a pool thread, the
+    // database thread stays free for the window's reads.
+    QtConcurrent::run([filePaths]() {
+        ImportPipeline pipeline;
+        ImportOutcome outcome;
+        
+        if (!pipeline.run(filePaths)) {
+            outcome.message = "Failed to import files:\n" + pipeline.getLastError() +
+                              "\n\nNo students were imported.";
+            return outcome;
+        }
+        
+        int skipped = 0;
+        for (const ImportFileResult& result : pipeline.getResults()) {
+            skipped += result.skippedCount;
+        }
+        
+        outcome.status = ImportOutcome::Success;
+        outcome.message = QString("Successfully imported %1 students from %2 files!")
+                              .arg(pipeline.getImportedCount())
+                              .arg(filePaths.size());
+        if (skipped > 0) {
+            outcome.message += QString("\n\n%1 malformed rows were skipped.").arg(skipped);
+        }
+        return outcome;
+    }).then(this, [this, filePaths](const ImportOutcome& outcome) {
+        onImportFinished(outcome, filePaths.first());
+    });
+}
+
+void MainWindow::onImportFinished(const ImportOutcome& outcome, const QString& filePath) {
+    setImportRunning(false);
+    
+    switch (outcome.status) {
+    case ImportOutcome::Success:
+        QMessageBox::information(this, "Import Success", outcome.message);
         
         loadClasses();
         loadStudents();
@@ -416,23 +630,46 @@ void MainWindow::importCSV(const QString& filePath) {
             UserConfig::KEY_LAST_IMPORT_PATH, 
             filePath
         );
-    } else {
-        QMessageBox::critical(this, "Import Error",
-            "Failed to import students:\n" + 
-            DatabaseManager::instance().getLastError());
+        break;
+    case ImportOutcome::Warning:
+        QMessageBox::warning(this, "Import Warning", outcome.message);
+        break;
+    case ImportOutcome::Failed:
+        QMessageBox::critical(this, "Import Error", outcome.message);
+        break;
     }
 }
 
-void MainWindow::importXLSX(const QString& filePath) {
-    XLSXReader reader;
-    
-    if (!reader.readFile(filePath)) {
-        QMessageBox::information(this, "XLSX Not Supported", 
-            reader.getLastError());
-        return;
+void MainWindow::setImportRunning(bool running) {
+    m_importButton->setEnabled(!running);
+    m_importAction->setEnabled(!running);
+    m_importPhotosAction->setEnabled(!running);
+    if (running) {
+        m_statusLabel->setText("Importing...");
     }
 }
 
+void MainWindow::importCSV(const QString& filePath) {
+    importFile(filePath, "CSV");
+}
+
+void MainWindow::importXLSX(const QString& filePath) {
+    importFile(filePath, "XLSX");
+}
+
+void MainWindow::backfillThumbnails(int afterId) {
+    // One batch per job so other database work keeps flowing in between
+    DatabaseWorker::instance()
+        .run([afterId](DatabaseManager& db) {
+            return db.backfillThumbnails(afterId);
+        })
+        .then(this, [this](int lastId) {
+            if (lastId != -1) {
+                backfillThumbnails(lastId);
+            }
+        });
+}
+
 void MainWindow::saveWindowState() {
     UserConfig::instance().setValue(
         UserConfig::KEY_WINDOW_GEOMETRY, 
@@ -479,17 +716,24 @@ void MainWindow::onImportClicked() {
         QDir::homePath()
     ).toString();
     
-    QString filePath = QFileDialog::getOpenFileName(
+    QStringList filePaths = QFileDialog::getOpenFileNames(
         this,
         "Import Student Data",
         lastPath,
         "Data Files (*.csv *.xlsx);;CSV Files (*.csv);;Excel Files (*.xlsx);;All Files (*.*)"
     );
     
-    if (filePath.isEmpty()) {
+    if (filePaths.isEmpty()) {
         return;
     }
     
+    if (filePaths.size() > 1) {
+        Logger::info("Importing", filePaths.size(), "files");
+        importFiles(filePaths);
+        return;
+    }
+    
+    QString filePath = filePaths.first();
     Logger::info("Importing file:", filePath);
     
     if (filePath.endsWith(".csv", Qt::CaseInsensitive)) {
@@ -511,39 +755,50 @@ void MainWindow::onPickRandomClicked() {
         return;
     }
     
-    int studentCount = DatabaseManager::instance().countStudentsByClass(
-        DatabaseManager::instance().getClassID(currentClass)
-    );
-    
-    if (studentCount == 0) {
-        QMessageBox::information(this, "No Students",
-            "No students found in this class.");
-        return;
-    }
-    
-    Student randomStudent = DatabaseManager::instance().getRandomStudentClassName(currentClass);
-    
-    if (randomStudent.id == -1) {
-        QMessageBox::warning(this, "Error",
-            "Failed to pick random student.");
-        return;
-    }
-    
-    m_selectedStudentId = randomStudent.id;
-    displaySelectedStudent();
-    
-    QVector<Student> students = m_tableModel->getAllStudents();
-    for (int i = 0; i < students.size(); i++) {
-        if (students[i].id == randomStudent.id) {
-            m_tableView->selectRow(i);
-            m_tableView->scrollTo(m_tableModel->index(i, 0));
-            break;
-        }
-    }
-    
-    m_statusLabel->setText(QString("🎲 Random Pick: %1").arg(randomStudent.name));
+    const bool fairPick = m_fairPickCheckBox->isChecked();
+    const int classFilter = m_tableModel->classFilter();
     
-    Logger::info("Random pick:", randomStudent.name, "from", currentClass);
+    // An empty class yields an invalid student, no separate count query
+    DatabaseWorker::instance()
+        .run([currentClass, fairPick, classFilter](DatabaseManager& db) {
+            Student student = fairPick ? db.getFairStudentClassName(currentClass)
+                                       : db.getRandomStudentClassName(currentClass);
+            
+            // Table row for when the student's page is not loaded
+            StudentSummary key;
+            key.id = student.id;
+            key.classId = student.classId;
+            key.name = student.name;
+            
+            return qMakePair(student, db.studentPosition(classFilter, key));
+        })
+        .then(this, [this, currentClass](const QPair<Student, int>& pick) {
+            const Student& randomStudent = pick.first;
+            
+            if (randomStudent.id == -1) {
+                QMessageBox::information(this, "No Students",
+                    "No students found in this class.");
+                return;
+            }
+            
+            m_selectedStudentId = randomStudent.id;
+            displaySelectedStudent();
+            
+            // The position is in the full class list, not in search results
+            int row = m_tableModel->rowForId(randomStudent.id);
+            if (row == -1 && !m_tableModel->isSearching()) {
+                row = pick.second;
+            }
+            
+            if (row != -1 && row < m_tableModel->rowCount()) {
+                m_tableView->selectRow(row);
+                m_tableView->scrollTo(m_tableModel->index(row, 0));
+            }
+            
+            m_statusLabel->setText(QString("🎲 Random Pick: %1").arg(randomStudent.name));
+            
+            Logger::info("Random pick:", randomStudent.name, "from", currentClass);
+        });
 }
 
 void MainWindow::onUploadPhotoClicked() {
@@ -563,7 +818,7 @@ void MainWindow::onUploadPhotoClicked() {
     }
     
     ImageProcessor processor;
-    if (!processor.loadFromFile(filePath)) {
+    if (!processor.loadFromFile(filePath, GlobalConf::MAX_PHOTO_DIMENSION)) {
         QMessageBox::critical(this, "Error",
             "Failed to load image:\n" + processor.getLastError());
         return;
@@ -575,24 +830,92 @@ void MainWindow::onUploadPhotoClicked() {
     
     if (compressedData.isEmpty()) {
         QMessageBox::critical(this, "Error",
-            "Failed to compress image.");
+            "Failed to compress image:\n" + processor.getLastError());
         return;
     }
     
-    Student student = DatabaseManager::instance().getStudentId(m_selectedStudentId);
-    student.photoData = compressedData;
+    const int studentId = m_selectedStudentId;
     
-    if (DatabaseManager::instance().updateStudent(student)) {
-        QMessageBox::information(this, "Success",
-            "Photo uploaded successfully!");
-        
-        displaySelectedStudent();
-        loadStudents();
-    } else {
-        QMessageBox::critical(this, "Error",
-            "Failed to upload photo:\n" + 
-            DatabaseManager::instance().getLastError());
+    DatabaseWorker::instance()
+        .run([studentId, compressedData](DatabaseManager& db) {
+            Student student = db.getStudentId(studentId);
+            student.photoData = compressedData;
+            
+            bool success = db.updateStudent(student);
+            return qMakePair(success, success ? QString() : db.getLastError());
+        })
+        .then(this, [this](const QPair<bool, QString>& result) {
+            if (result.first) {
+                QMessageBox::information(this, "Success",
+                    "Photo uploaded successfully!");
+                
+                // The table row follows through the studentsUpdated event,
+                // the panel needs the new photo version right away
+                loadSelectedStudent();
+            } else {
+                QMessageBox::critical(this, "Error",
+                    "Failed to upload photo:\n" + result.second);
+            }
+        });
+}
+
+void MainWindow::onImportPhotosClicked() {
+    QString directory = QFileDialog::getExistingDirectory(
+        this,
+        "Select Photo Folder (file name = StudentID)",
+        QDir::homePath()
+    );
+    
+    if (directory.isEmpty()) {
+        return;
     }
+    
+    Logger::info("Importing photos from:", directory);
+    setImportRunning(true);
+    
+    // Images are processed on all cores and collected on a pool thread,
+    // only the batched writes are queued to the database thread
+    QtConcurrent::run([directory]() {
+        PhotoImportPipeline pipeline;
+        ImportOutcome outcome;
+        
+        bool success = pipeline.run(directory);
+        
+        QString message = QString("Updated photos of %1 students.")
+                              .arg(pipeline.getUpdatedCount());
+        if (!pipeline.getUnmatchedFiles().isEmpty()) {
+            message += QString("\n\n%1 files did not match any StudentID.")
+                           .arg(pipeline.getUnmatchedFiles().size());
+        }
+        if (!pipeline.getFailedFiles().isEmpty()) {
+            message += QString("\n\n%1 files could not be read:\n%2")
+                           .arg(pipeline.getFailedFiles().size())
+                           .arg(pipeline.getFailedFiles().mid(0, 10).join(", "));
+        }
+        
+        if (success) {
+            outcome.status = ImportOutcome::Success;
+            outcome.message = message;
+        } else {
+            outcome.message = "Failed to import photos:\n" + pipeline.getLastError() +
+                              "\n\n" + message;
+        }
+        return outcome;
+    }).then(this, [this](const ImportOutcome& outcome) {
+        setImportRunning(false);
+        
+        if (outcome.status == ImportOutcome::Success) {
+            QMessageBox::information(this, "Photo Import", outcome.message);
+            
+            // The table reloads through studentsReset, the panel may
+            // show a photo that was just replaced
+            if (m_selectedStudentId != -1) {
+                loadSelectedStudent();
+            }
+        } else {
+            QMessageBox::critical(this, "Photo Import Error", outcome.message);
+        }
+    });
 }
 
 void MainWindow::onClearDatabaseClicked() {
@@ -605,21 +928,29 @@ void MainWindow::onClearDatabaseClicked() {
         QMessageBox::No
     );
     
-    if (reply == QMessageBox::Yes) {
-        if (DatabaseManager::instance().clearAllStudents()) {
-            QMessageBox::information(this, "Success",
-                "All student data has been cleared.");
-            
-            m_selectedStudentId = -1;
-            loadClasses();
-            loadStudents();
-            displaySelectedStudent();
-        } else {
-            QMessageBox::critical(this, "Error",
-                "Failed to clear database:\n" + 
-                DatabaseManager::instance().getLastError());
-        }
+    if (reply != QMessageBox::Yes) {
+        return;
     }
+    
+    DatabaseWorker::instance()
+        .run([](DatabaseManager& db) {
+            bool success = db.clearAllStudents();
+            return qMakePair(success, success ? QString() : db.getLastError());
+        })
+        .then(this, [this](const QPair<bool, QString>& result) {
+            if (result.first) {
+                QMessageBox::information(this, "Success",
+                    "All student data has been cleared.");
+                
+                m_selectedStudentId = -1;
+                loadClasses();
+                loadStudents();
+                displaySelectedStudent();
+            } else {
+                QMessageBox::critical(this, "Error",
+                    "Failed to clear database:\n" + result.second);
+            }
+        });
 }
 
 void MainWindow::onRefreshClicked() {
@@ -640,6 +971,24 @@ void MainWindow::onClassChanged(int index) {
     Q_UNUSED(index);
     QString className = m_classComboBox->currentText();
     loadStudentsByClass(className);
+    
+    // Search results are limited to the selected class
+    if (m_tableModel->isSearching()) {
+        runSearch();
+    }
+}
+
+void MainWindow::runSearch() {
+    m_searchTimer->stop();
+    QString keyword = m_searchEdit->text().trimmed();
+    
+    if (keyword.isEmpty()) {
+        m_studentSearch->cancel();
+        m_tableModel->clearSearch();
+        return;
+    }
+    
+    m_studentSearch->search(keyword, m_tableModel->classFilter());
 }
 
 void MainWindow::onTableSelectionChanged() {
@@ -652,7 +1001,12 @@ void MainWindow::onTableSelectionChanged() {
     }
     
     int row = selection.first().row();
-    Student student = m_tableModel->getStudent(row);
+    StudentSummary student = m_tableModel->getStudent(row);
+    
+    // Page still loading, a pick has already set the selected id
+    if (student.id == -1) {
+        return;
+    }
     m_selectedStudentId = student.id;
     
     displaySelectedStudent();
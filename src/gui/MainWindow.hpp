@@ -6,10 +6,15 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QComboBox>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include "../core/DatabaseManager.hpp"
 #include "StudentTableModel.hpp"
+#include "ThumbnailLoader.hpp"
+#include "StudentSearch.hpp"
 
 namespace StudentPicker {
 
@@ -28,6 +33,7 @@ private slots:
     void onImportClicked();
     void onPickRandomClicked();
     void onUploadPhotoClicked();
+    void onImportPhotosClicked();
     void onClearDatabaseClicked();
     void onRefreshClicked();
     
@@ -36,6 +42,11 @@ private slots:
     
     // Slot untuk table selection
     void onTableSelectionChanged();
+    void onStudentCountChanged(int count);
+    void onThumbnailReady(int studentId, int photoVersion, const QSize& size, const QPixmap& pixmap);
+    
+    // Slot untuk search
+    void runSearch();
     
 private:
     // Setup UI
@@ -48,8 +59,28 @@ private:
     void loadStudents();
     void loadStudentsByClass(const QString& className);
     void displaySelectedStudent();
+    void loadSelectedStudent();
+    void showStudent(const StudentSummary& student);
     void importCSV(const QString& filePath);
     void importXLSX(const QString& filePath);
+    void importFiles(const QStringList& filePaths);
+    void importFile(const QString& filePath, const QString& format);
+    
+    // Result of an import job, built on the database thread
+    struct ImportOutcome {
+        enum Status { Success, Warning, Failed };
+        Status status = Failed;
+        QString message;
+    };
+    
+    // Stream rows from a CSVReader/XLSXReader into one import transaction,
+    // runs on the database thread
+    template<typename Reader>
+    static ImportOutcome importRows(DatabaseManager& db, Reader& reader,
+                                    const QString& filePath, const QString& format);
+    void onImportFinished(const ImportOutcome& outcome, const QString& filePath);
+    void setImportRunning(bool running);
+    void backfillThumbnails(int afterId = 0);
     void saveWindowState();
     void restoreWindowState();
     
@@ -60,13 +91,23 @@ private:
     // Top controls
     QHBoxLayout* m_topLayout;
     QPushButton* m_importButton;
+    QAction* m_importAction;
+    QAction* m_importPhotosAction;
     QComboBox* m_classComboBox;
     QPushButton* m_pickRandomButton;
+    QCheckBox* m_fairPickCheckBox;
+    QLineEdit* m_searchEdit;
     QPushButton* m_refreshButton;
     
+    // Restarted on every keystroke, the search runs once typing pauses
+    static constexpr int SEARCH_DEBOUNCE_MS = 150;
+    QTimer* m_searchTimer;
+    StudentSearch* m_studentSearch;
+    
     // Table
     QTableView* m_tableView;
     StudentTableModel* m_tableModel;
+    ThumbnailLoader* m_thumbnailLoader;
     
     // Bottom section - Selected student display
     QHBoxLayout* m_bottomLayout;
@@ -86,6 +127,8 @@ private:
     
     // Data
     int m_selectedStudentId;
+    // Photo version of the student in the panel, older thumbnails are dropped
+    int m_shownPhotoVersion;
     QVector<QVariantMap> m_classes;
 };
 
@@ -0,0 +1,80 @@
+#include "StudentSearch.hpp"
+#include "../core/DatabaseWorker.hpp"
+#include "../core/logger.hpp"
+
+namespace StudentPicker {
+
+StudentSearch::StudentSearch(QObject* parent)
+    : QObject(parent), m_buildGeneration(0), m_searchGeneration(0) {
+    m_rebuildTimer.setSingleShot(true);
+    m_rebuildTimer.setInterval(REBUILD_DELAY_MS);
+    connect(&m_rebuildTimer, &QTimer::timeout, this, &StudentSearch::rebuild);
+    
+    // A burst of edits or an import only triggers one rebuild
+    DatabaseManager& db = DatabaseManager::instance();
+    auto scheduleRebuild = [this]() { m_rebuildTimer.start(); };
+    connect(&db, &DatabaseManager::studentsInserted, this, scheduleRebuild);
+    connect(&db, &DatabaseManager::studentsUpdated, this, scheduleRebuild);
+    connect(&db, &DatabaseManager::studentsDeleted, this, scheduleRebuild);
+    connect(&db, &DatabaseManager::studentsReset, this, scheduleRebuild);
+}
+
+bool StudentSearch::isReady() const {
+    return m_index != nullptr;
+}
+
+void StudentSearch::rebuild() {
+    m_rebuildTimer.stop();
+    const int generation = ++m_buildGeneration;
+    
+    // Rows are read on the database thread, the index is built on the pool
+    DatabaseWorker::instance()
+        .run([](DatabaseManager& db) {
+            return db.getAllStudentSummaries();
+        })
+        .then(QtFuture::Launch::Async, [](const QVector<StudentSummary>& students) {
+            auto index = std::make_shared<StudentSearchIndex>();
+            index->build(students);
+            return std::shared_ptr<const StudentSearchIndex>(index);
+        })
+        .then(this, [this, generation](std::shared_ptr<const StudentSearchIndex> index) {
+            if (generation != m_buildGeneration) {
+                return;
+            }
+            
+            m_index = index;
+            Logger::info("Search index built for", m_index->size(), "students");
+            emit indexRebuilt();
+        });
+}
+
+void StudentSearch::search(const QString& keyword, int classId) {
+    const int generation = ++m_searchGeneration;
+    
+    if (m_index) {
+        emit resultsReady(m_index->find(keyword, classId));
+        return;
+    }
+    
+    DatabaseWorker::instance()
+        .run([keyword, classId](DatabaseManager& db) {
+            QVector<int> ids;
+            for (const StudentSummary& student : db.searchStudentSummariesName(keyword)) {
+                if (classId == -1 || student.classId == classId) {
+                    ids.append(student.id);
+                }
+            }
+            return ids;
+        })
+        .then(this, [this, generation](const QVector<int>& ids) {
+            if (generation == m_searchGeneration) {
+                emit resultsReady(ids);
+            }
+        });
+}
+
+void StudentSearch::cancel() {
+    ++m_searchGeneration;
+}
+
+} // namespace StudentPicker
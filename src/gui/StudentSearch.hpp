@@ -0,0 +1,55 @@
+#ifndef STUDENTSEARCH_HPP
+#define STUDENTSEARCH_HPP
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "../core/StudentSearchIndex.hpp"
+
+namespace StudentPicker {
+
+// As-you-type search for the student table. The in-memory trigram index
+// is built off the GUI thread after load and rebuilt a moment after the
+// students change, a search on a ready index is answered right away on
+// the GUI thread. Until the first index is ready the database search is
+// used instead.
+class StudentSearch : public QObject {
+    Q_OBJECT
+    
+public:
+    // Quiet time after a change to the students before the rebuild
+    static constexpr int REBUILD_DELAY_MS = 500;
+    
+    explicit StudentSearch(QObject* parent = nullptr);
+    
+    bool isReady() const;
+    
+    // Start building the index now
+    void rebuild();
+    
+    // resultsReady follows, synchronously when the index is ready. Results
+    // of an older search are dropped.
+    void search(const QString& keyword, int classId);
+    
+    // Drop the results of a search still in flight
+    void cancel();
+    
+signals:
+    // Row ids in list order
+    void resultsReady(const QVector<int>& ids);
+    
+    // A new index replaced the old one, active searches should run again
+    void indexRebuilt();
+    
+private:
+    std::shared_ptr<const StudentSearchIndex> m_index;
+    QTimer m_rebuildTimer;
+    int m_buildGeneration;
+    int m_searchGeneration;
+};
+
+} // namespace StudentPicker
+
+#endif // STUDENTSEARCH_HPP
@@ -1,17 +1,60 @@
 #include "StudentTableModel.hpp"
+#include "../core/DatabaseWorker.hpp"
+#include "../core/global.hpp"
+#include <algorithm>
 
 namespace StudentPicker {
 
+namespace {
+
+// Where a changed student sits in the current list. A deleted student
+// keeps its id, the summary comes back invalid.
+struct ResolvedStudent {
+    int id;
+    StudentSummary summary;
+    int position;
+};
+
+struct ResolvedChanges {
+    QVector<ResolvedStudent> students;
+    int count;
+};
+
+QFuture<ResolvedChanges> resolveChanges(int classId, const QVector<int>& ids) {
+    return DatabaseWorker::instance().run([classId, ids](DatabaseManager& db) {
+        ResolvedChanges changes;
+        for (int id : ids) {
+            ResolvedStudent resolved;
+            resolved.id = id;
+            resolved.summary = db.getStudentSummaryId(id);
+            resolved.position = db.studentPosition(classId, resolved.summary);
+            changes.students.append(resolved);
+        }
+        changes.count = classId == -1 ? db.countStudents() : db.countStudentsByClass(classId);
+        return changes;
+    });
+}
+
+} // namespace
+
 StudentTableModel::StudentTableModel(QObject* parent)
-    : QAbstractTableModel(parent) {
+    : QAbstractTableModel(parent), m_classId(-1), m_rowCount(0), m_searching(false),
+      m_generation(0), m_pageEpoch(0), m_pages(MAX_CACHED_PAGES), m_thumbnailLoader(nullptr) {
     m_headers << "ID" << "Name" << "Student ID" << "Class" << "Has Photo";
+    
+    // Emitted on the database thread, delivered queued
+    DatabaseManager& db = DatabaseManager::instance();
+    connect(&db, &DatabaseManager::studentsInserted, this, &StudentTableModel::onStudentsInserted);
+    connect(&db, &DatabaseManager::studentsUpdated, this, &StudentTableModel::onStudentsUpdated);
+    connect(&db, &DatabaseManager::studentsDeleted, this, &StudentTableModel::onStudentsDeleted);
+    connect(&db, &DatabaseManager::studentsReset, this, &StudentTableModel::reload);
 }
 
 int StudentTableModel::rowCount(const QModelIndex& parent) const {
     if (parent.isValid()) {
         return 0;
     }
-    return m_students.size();
+    return m_rowCount;
 }
 
 int StudentTableModel::columnCount(const QModelIndex& parent) const {
@@ -22,23 +65,10 @@ int StudentTableModel::columnCount(const QModelIndex& parent) const {
 }
 
 QVariant StudentTableModel::data(const QModelIndex& index, int role) const {
-    if (!index.isValid() || index.row() >= m_students.size()) {
+    if (!index.isValid() || index.row() >= m_rowCount) {
         return QVariant();
     }
     
-    const Student& student = m_students[index.row()];
-    
-    if (role == Qt::DisplayRole) {
-        switch (index.column()) {
-            case 0: return student.id;
-            case 1: return student.name;
-            case 2: return student.studentId;
-            case 3: return student.className;
-            case 4: return student.photoData.isEmpty() ? "No" : "Yes";
-            default: return QVariant();
-        }
-    }
-    
     if (role == Qt::TextAlignmentRole) {
         if (index.column() == 0 || index.column() == 4) {
             return Qt::AlignCenter;
@@ -46,7 +76,55 @@ QVariant StudentTableModel::data(const QModelIndex& index, int role) const {
         return QVariant(Qt::AlignLeft | Qt::AlignVCenter);
     }
     
-    return QVariant();
+    const bool thumbnail = role == Qt::DecorationRole && index.column() == 4 && m_thumbnailLoader;
+    if (role != Qt::DisplayRole && !thumbnail) {
+        return QVariant();
+    }
+    
+    int pageIndex = index.row() / PAGE_SIZE;
+    int offset = index.row() % PAGE_SIZE;
+    const QVector<StudentSummary>* rows = page(pageIndex);
+    
+    // A page left short by a removal is fetched again
+    if (rows && offset >= rows->size()) {
+        requestPage(pageIndex);
+        rows = nullptr;
+    }
+    
+    if (!rows) {
+        return index.column() == 1 && role == Qt::DisplayRole ? QVariant("Loading...") : QVariant();
+    }
+    
+    const StudentSummary& student = rows->at(offset);
+    
+    // A search result deleted since the search ran
+    if (student.id == -1) {
+        return QVariant();
+    }
+    
+    if (thumbnail) {
+        if (!student.hasPhoto) {
+            return QVariant();
+        }
+        
+        // Decoded in the background, onThumbnailReady repaints the cell
+        const QSize size(GlobalConf::LIST_THUMBNAIL_SIZE, GlobalConf::LIST_THUMBNAIL_SIZE);
+        QPixmap pixmap = m_thumbnailLoader->cached(student.id, student.photoVersion, size);
+        if (pixmap.isNull()) {
+            m_thumbnailLoader->request(student.id, student.photoVersion, size);
+            return QVariant();
+        }
+        return pixmap;
+    }
+    
+    switch (index.column()) {
+        case 0: return student.id;
+        case 1: return student.name;
+        case 2: return student.studentId;
+        case 3: return student.className;
+        case 4: return student.hasPhoto ? "Yes" : "No";
+        default: return QVariant();
+    }
 }
 
 QVariant StudentTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
@@ -65,48 +143,435 @@ QVariant StudentTableModel::headerData(int section, Qt::Orientation orientation,
     return QVariant();
 }
 
-void StudentTableModel::setStudents(const QVector<Student>& students) {
-    beginResetModel();
-    m_students = students;
-    endResetModel();
+void StudentTableModel::setThumbnailLoader(ThumbnailLoader* loader) {
+    m_thumbnailLoader = loader;
+    connect(loader, &ThumbnailLoader::thumbnailReady, this, &StudentTableModel::onThumbnailReady);
 }
 
-void StudentTableModel::addStudent(const Student& student) {
-    beginInsertRows(QModelIndex(), m_students.size(), m_students.size());
-    m_students.append(student);
-    endInsertRows();
+void StudentTableModel::onThumbnailReady(int studentId, int photoVersion, const QSize& size,
+                                         const QPixmap& pixmap) {
+    if (size != QSize(GlobalConf::LIST_THUMBNAIL_SIZE, GlobalConf::LIST_THUMBNAIL_SIZE) || pixmap.isNull()) {
+        return;
+    }
+    
+    // A row whose photo changed meanwhile has asked for the new version
+    int row = rowForId(studentId);
+    if (row != -1 && getStudent(row).photoVersion == photoVersion) {
+        QModelIndex cell = index(row, 4);
+        emit dataChanged(cell, cell, {Qt::DecorationRole});
+    }
 }
 
-void StudentTableModel::updateStudent(int row, const Student& student) {
-    if (row >= 0 && row < m_students.size()) {
-        m_students[row] = student;
-        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
-    }
+void StudentTableModel::setClassFilter(int classId) {
+    m_classId = classId;
+    reload();
 }
 
-void StudentTableModel::removeStudent(int row) {
-    if (row >= 0 && row < m_students.size()) {
-        beginRemoveRows(QModelIndex(), row, row);
-        m_students.removeAt(row);
-        endRemoveRows();
+int StudentTableModel::classFilter() const {
+    return m_classId;
+}
+
+void StudentTableModel::reload() {
+    // The search owner runs the search again, refetch what is shown meanwhile
+    if (m_searching) {
+        setSearchResults(m_searchIds);
+        return;
     }
+    
+    const int generation = ++m_generation;
+    const int classId = m_classId;
+    
+    // Only the count is read here, rows follow when the view asks for them
+    DatabaseWorker::instance()
+        .run([classId](DatabaseManager& db) {
+            return classId == -1 ? db.countStudents() : db.countStudentsByClass(classId);
+        })
+        .then(this, [this, generation](int count) {
+            if (generation != m_generation) {
+                return;
+            }
+            
+            beginResetModel();
+            m_rowCount = count;
+            m_pages.clear();
+            m_pendingPages.clear();
+            m_rowForId.clear();
+            ++m_pageEpoch;
+            endResetModel();
+            
+            emit studentCountChanged(count);
+        });
 }
 
 void StudentTableModel::clear() {
+    ++m_generation;
+    
     beginResetModel();
-    m_students.clear();
+    m_rowCount = 0;
+    m_pages.clear();
+    m_pendingPages.clear();
+    m_rowForId.clear();
+    ++m_pageEpoch;
     endResetModel();
 }
 
-Student StudentTableModel::getStudent(int row) const {
-    if (row >= 0 && row < m_students.size()) {
-        return m_students[row];
+void StudentTableModel::setSearchResults(const QVector<int>& ids) {
+    ++m_generation;
+    
+    beginResetModel();
+    m_searching = true;
+    m_searchIds = ids;
+    m_rowCount = ids.size();
+    m_pages.clear();
+    m_pendingPages.clear();
+    m_rowForId.clear();
+    ++m_pageEpoch;
+    endResetModel();
+    
+    emit studentCountChanged(m_rowCount);
+}
+
+void StudentTableModel::clearSearch() {
+    if (!m_searching) {
+        return;
     }
-    return Student();
+    
+    m_searching = false;
+    m_searchIds.clear();
+    reload();
 }
 
-QVector<Student> StudentTableModel::getAllStudents() const {
-    return m_students;
+bool StudentTableModel::isSearching() const {
+    return m_searching;
+}
+
+StudentSummary StudentTableModel::getStudent(int row) const {
+    if (row < 0 || row >= m_rowCount) {
+        return StudentSummary();
+    }
+    
+    const QVector<StudentSummary>* rows = page(row / PAGE_SIZE);
+    int offset = row % PAGE_SIZE;
+    
+    if (rows && offset < rows->size()) {
+        return rows->at(offset);
+    }
+    return StudentSummary();
+}
+
+int StudentTableModel::rowForId(int studentId) const {
+    auto it = m_rowForId.constFind(studentId);
+    if (it == m_rowForId.constEnd()) {
+        return -1;
+    }
+    
+    int row = it.value();
+    const QVector<StudentSummary>* rows = m_pages.object(row / PAGE_SIZE);
+    int offset = row % PAGE_SIZE;
+    
+    if (rows && offset < rows->size() && rows->at(offset).id == studentId) {
+        return row;
+    }
+    return -1;
+}
+
+const QVector<StudentSummary>* StudentTableModel::page(int pageIndex) const {
+    const QVector<StudentSummary>* rows = m_pages.object(pageIndex);
+    if (!rows) {
+        requestPage(pageIndex);
+    }
+    return rows;
+}
+
+void StudentTableModel::requestPage(int pageIndex) const {
+    if (m_pendingPages.contains(pageIndex)) {
+        return;
+    }
+    m_pendingPages.insert(pageIndex);
+    
+    const int epoch = m_pageEpoch;
+    const int classId = m_classId;
+    
+    // data() is const, the page still has to be stored when it arrives
+    StudentTableModel* self = const_cast<StudentTableModel*>(this);
+    
+    if (m_searching) {
+        const QVector<int> ids = m_searchIds.mid(pageIndex * PAGE_SIZE, PAGE_SIZE);
+        
+        DatabaseWorker::instance()
+            .run([ids](DatabaseManager& db) {
+                return db.getStudentSummariesByIds(ids);
+            })
+            .then(self, [self, epoch, pageIndex](const QVector<StudentSummary>& rows) {
+                self->onPageLoaded(epoch, pageIndex, rows);
+            });
+        return;
+    }
+    
+    // Scrolling down mostly asks for the page after a loaded one, seek from
+    // its last row instead of making SQLite walk the OFFSET
+    bool seek = false;
+    StudentSummary last;
+    if (const QVector<StudentSummary>* previous = m_pages.object(pageIndex - 1)) {
+        if (previous->size() == PAGE_SIZE) {
+            seek = true;
+            last = previous->last();
+        }
+    }
+    
+    DatabaseWorker::instance()
+        .run([classId, pageIndex, seek, last](DatabaseManager& db) {
+            if (seek) {
+                return db.getStudentSummariesAfter(classId, last.name, last.id, PAGE_SIZE);
+            }
+            return db.getStudentSummariesPage(classId, pageIndex * PAGE_SIZE, PAGE_SIZE);
+        })
+        .then(self, [self, epoch, pageIndex](const QVector<StudentSummary>& rows) {
+            self->onPageLoaded(epoch, pageIndex, rows);
+        });
+}
+
+void StudentTableModel::onPageLoaded(int epoch, int pageIndex, const QVector<StudentSummary>& rows) {
+    if (epoch != m_pageEpoch) {
+        return;
+    }
+    
+    m_pendingPages.remove(pageIndex);
+    m_pages.insert(pageIndex, new QVector<StudentSummary>(rows));
+    
+    int first = pageIndex * PAGE_SIZE;
+    
+    // Keep the index near the resident size as evicted pages pile up
+    if (m_rowForId.size() > 2 * MAX_CACHED_PAGES * PAGE_SIZE) {
+        rebuildRowIndex();
+    } else {
+        for (int i = 0; i < rows.size(); i++) {
+            m_rowForId.insert(rows[i].id, first + i);
+        }
+    }
+    
+    int last = qMin(first + PAGE_SIZE, m_rowCount) - 1;
+    if (first <= last) {
+        emit dataChanged(index(first, 0), index(last, columnCount() - 1));
+    }
+}
+
+void StudentTableModel::onStudentsInserted(const QVector<int>& ids) {
+    applyChanges(ids, true);
+}
+
+void StudentTableModel::onStudentsUpdated(const QVector<int>& ids) {
+    applyChanges(ids, false);
+}
+
+void StudentTableModel::onStudentsDeleted(const QVector<int>& ids) {
+    applyChanges(ids, false);
+}
+
+void StudentTableModel::applyChanges(const QVector<int>& ids, bool newRows) {
+    // Positions are only known for the full list, the search results are
+    // replaced after the next index rebuild. Until then the shown rows are
+    // fetched again so edits show up.
+    if (m_searching) {
+        refreshRows(m_rowCount);
+        return;
+    }
+    
+    const int generation = m_generation;
+    
+    resolveChanges(m_classId, ids).then(this, [this, generation, newRows](const ResolvedChanges& changes) {
+        if (generation != m_generation) {
+            return;
+        }
+        
+        bool exact = true;
+        QVector<ResolvedStudent> inserts;
+        
+        // Resident rows first, positions are in the final order so every
+        // insert waits until the removals are done
+        for (const ResolvedStudent& resolved : changes.students) {
+            int row = rowForId(resolved.id);
+            
+            if (row == -1) {
+                if (resolved.position != -1) {
+                    if (newRows) {
+                        inserts.append(resolved);
+                    } else {
+                        // Old row unknown, it may have moved across resident pages
+                        exact = false;
+                    }
+                }
+                continue;
+            }
+            
+            if (resolved.summary.id == -1) {
+                removeStudentRow(row);
+            } else if (resolved.position == row) {
+                replaceStudentRow(row, resolved.summary);
+            } else {
+                removeStudentRow(row);
+                if (resolved.position != -1) {
+                    inserts.append(resolved);
+                }
+            }
+        }
+        
+        std::sort(inserts.begin(), inserts.end(),
+                  [](const ResolvedStudent& a, const ResolvedStudent& b) {
+                      return a.position < b.position;
+                  });
+        
+        for (const ResolvedStudent& resolved : inserts) {
+            if (resolved.position > m_rowCount) {
+                exact = false;
+                break;
+            }
+            insertStudentRow(resolved.position, resolved.summary);
+        }
+        
+        // Deletes outside the resident pages only show up in the count
+        if (!exact || m_rowCount != changes.count) {
+            refreshRows(changes.count);
+        }
+        
+        emit studentCountChanged(m_rowCount);
+    });
+}
+
+void StudentTableModel::insertStudentRow(int row, const StudentSummary& student) {
+    const int lastPage = m_rowCount / PAGE_SIZE;
+    
+    beginInsertRows(QModelIndex(), row, row);
+    
+    // Every resident page from the row on shifts down by one, the row pushed
+    // out of a full page moves to the front of the next one. Past a page that
+    // is not resident the carried row is lost and later pages are dropped.
+    StudentSummary carry = student;
+    int offset = row % PAGE_SIZE;
+    bool intact = true;
+    
+    for (int pageIndex = row / PAGE_SIZE; pageIndex <= lastPage; pageIndex++) {
+        QVector<StudentSummary>* rows = intact ? m_pages.object(pageIndex) : nullptr;
+        if (!rows || offset > rows->size()) {
+            m_pages.remove(pageIndex);
+            intact = false;
+            continue;
+        }
+        
+        rows->insert(offset, carry);
+        offset = 0;
+        
+        if (rows->size() > PAGE_SIZE) {
+            carry = rows->takeLast();
+        } else {
+            intact = false;
+        }
+    }
+    
+    for (auto it = m_rowForId.begin(); it != m_rowForId.end(); ++it) {
+        if (it.value() >= row) {
+            ++it.value();
+        }
+    }
+    m_rowForId.insert(student.id, row);
+    
+    m_rowCount++;
+    m_pendingPages.clear();
+    ++m_pageEpoch;
+    
+    endInsertRows();
+}
+
+void StudentTableModel::removeStudentRow(int row) {
+    const int lastPage = (m_rowCount - 1) / PAGE_SIZE;
+    
+    beginRemoveRows(QModelIndex(), row, row);
+    
+    // Every resident page from the row on shifts up by one and takes the
+    // first row of the next page. A page whose successor is not resident is
+    // left short and fetched again when the view reaches it.
+    int offset = row % PAGE_SIZE;
+    bool intact = true;
+    
+    for (int pageIndex = row / PAGE_SIZE; pageIndex <= lastPage; pageIndex++) {
+        QVector<StudentSummary>* rows = intact ? m_pages.object(pageIndex) : nullptr;
+        if (!rows || offset >= rows->size()) {
+            m_pages.remove(pageIndex);
+            intact = false;
+            continue;
+        }
+        
+        rows->removeAt(offset);
+        offset = 0;
+        
+        QVector<StudentSummary>* next = pageIndex < lastPage ? m_pages.object(pageIndex + 1) : nullptr;
+        if (next && !next->isEmpty()) {
+            rows->append(next->first());
+        } else {
+            intact = false;
+        }
+    }
+    
+    for (auto it = m_rowForId.begin(); it != m_rowForId.end();) {
+        if (it.value() == row) {
+            it = m_rowForId.erase(it);
+            continue;
+        }
+        if (it.value() > row) {
+            --it.value();
+        }
+        ++it;
+    }
+    
+    m_rowCount--;
+    m_pendingPages.clear();
+    ++m_pageEpoch;
+    
+    endRemoveRows();
+}
+
+void StudentTableModel::replaceStudentRow(int row, const StudentSummary& student) {
+    QVector<StudentSummary>* rows = m_pages.object(row / PAGE_SIZE);
+    int offset = row % PAGE_SIZE;
+    
+    if (rows && offset < rows->size()) {
+        (*rows)[offset] = student;
+        m_rowForId.insert(student.id, row);
+        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    }
+}
+
+void StudentTableModel::refreshRows(int count) {
+    if (count > m_rowCount) {
+        beginInsertRows(QModelIndex(), m_rowCount, count - 1);
+        m_rowCount = count;
+        endInsertRows();
+    } else if (count < m_rowCount) {
+        beginRemoveRows(QModelIndex(), count, m_rowCount - 1);
+        m_rowCount = count;
+        endRemoveRows();
+    }
+    
+    m_pages.clear();
+    m_pendingPages.clear();
+    m_rowForId.clear();
+    ++m_pageEpoch;
+    
+    if (m_rowCount > 0) {
+        emit dataChanged(index(0, 0), index(m_rowCount - 1, columnCount() - 1));
+    }
+}
+
+void StudentTableModel::rebuildRowIndex() {
+    m_rowForId.clear();
+    
+    const QList<int> pageIndexes = m_pages.keys();
+    for (int pageIndex : pageIndexes) {
+        const QVector<StudentSummary>* rows = m_pages.object(pageIndex);
+        for (int i = 0; i < rows->size(); i++) {
+            m_rowForId.insert(rows->at(i).id, pageIndex * PAGE_SIZE + i);
+        }
+    }
 }
 
-} // namespace StudentPicker
\ No newline at end of file
+} // namespace StudentPicker
@@ -3,14 +3,27 @@
 
 #include <QAbstractTableModel>
 #include <QVector>
+#include <QCache>
+#include <QSet>
+#include <QHash>
 #include "../core/DatabaseManager.hpp"
+#include "ThumbnailLoader.hpp"
 
 namespace StudentPicker {
 
+// Virtual table over the students table. Only the row count is known up
+// front, rows are fetched page by page on the database thread as the view
+// asks for them and the least recently used pages are evicted. Single row
+// changes reported by DatabaseManager are applied as row inserts, removals
+// and dataChanged instead of a reset. While a search is active the rows
+// are the search results, paged by id in the order the search gave them.
 class StudentTableModel : public QAbstractTableModel {
     Q_OBJECT
     
 public:
+    static constexpr int PAGE_SIZE = 200;
+    static constexpr int MAX_CACHED_PAGES = 50;
+    
     explicit StudentTableModel(QObject* parent = nullptr);
     
     // QAbstractTableModel interface
@@ -20,20 +33,79 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     
     // Custom methods
-    void setStudents(const QVector<Student>& students);
-    void addStudent(const Student& student);
-    void updateStudent(int row, const Student& student);
-    void removeStudent(int row);
+    void setClassFilter(int classId);
+    int classFilter() const;
+    void reload();
     void clear();
     
-    Student getStudent(int row) const;
-    QVector<Student> getAllStudents() const;
+    // Show only these students, in this order, until clearSearch
+    void setSearchResults(const QVector<int>& ids);
+    void clearSearch();
+    bool isSearching() const;
+    
+    // Invalid summary if the row's page is not loaded
+    StudentSummary getStudent(int row) const;
+    
+    // Row of a student through the id index, -1 if its page is not resident
+    int rowForId(int studentId) const;
+    
+    // Source of the list thumbnails in the photo column, none by default
+    void setThumbnailLoader(ThumbnailLoader* loader);
+    
+signals:
+    // New row count after a reload or a change to the list
+    void studentCountChanged(int count);
+    
+private slots:
+    void onStudentsInserted(const QVector<int>& ids);
+    void onStudentsUpdated(const QVector<int>& ids);
+    void onStudentsDeleted(const QVector<int>& ids);
+    void onThumbnailReady(int studentId, int photoVersion, const QSize& size, const QPixmap& pixmap);
     
 private:
-    QVector<Student> m_students;
+    const QVector<StudentSummary>* page(int pageIndex) const;
+    void requestPage(int pageIndex) const;
+    void onPageLoaded(int epoch, int pageIndex, const QVector<StudentSummary>& rows);
+    
+    // Look the changed ids up again and patch the rows, newRows tells
+    // whether ids missing from the resident pages were just inserted
+    void applyChanges(const QVector<int>& ids, bool newRows);
+    
+    // Row level edits that keep the resident pages in step
+    void insertStudentRow(int row, const StudentSummary& student);
+    void removeStudentRow(int row);
+    void replaceStudentRow(int row, const StudentSummary& student);
+    
+    // Drop every page and refetch what the view shows, without a reset
+    void refreshRows(int count);
+    
+    // Rebuild the id index from the resident pages
+    void rebuildRowIndex();
+    
+    int m_classId;
+    int m_rowCount;
+    
+    bool m_searching;
+    QVector<int> m_searchIds;
+    
+    // Bumped on every reload, results for an older query are dropped
+    int m_generation;
+    
+    // Bumped whenever resident pages shift, in-flight pages are dropped
+    int m_pageEpoch;
+    
+    // Summaries only, photos are fetched on demand by the caller
+    mutable QCache<int, QVector<StudentSummary>> m_pages;
+    mutable QSet<int> m_pendingPages;
+    
+    // id -> row for the resident pages. Entries of evicted pages linger
+    // until the next rebuild, rowForId checks the row before trusting it.
+    QHash<int, int> m_rowForId;
     QStringList m_headers;
+    
+    ThumbnailLoader* m_thumbnailLoader;
 };
 
 } // namespace StudentPicker
 
-#endif // STUDENTTABLEMODEL_HPP
\ No newline at end of file
+#endif // STUDENTTABLEMODEL_HPP
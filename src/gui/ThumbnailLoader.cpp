@@ -0,0 +1,79 @@
+#include "ThumbnailLoader.hpp"
+#include "../core/DatabaseWorker.hpp"
+#include "../core/ImageProcessor.hpp"
+#include "../core/logger.hpp"
+#include "../core/global.hpp"
+#include <QImage>
+
+namespace StudentPicker {
+
+ThumbnailLoader::ThumbnailLoader(QObject* parent)
+    : QObject(parent), m_cache(CACHE_SIZE_KB) {
+}
+
+QPixmap ThumbnailLoader::cached(int studentId, int photoVersion, const QSize& size) const {
+    const QPixmap* pixmap = m_cache.object(cacheKey(studentId, photoVersion, size));
+    return pixmap ? *pixmap : QPixmap();
+}
+
+void ThumbnailLoader::request(int studentId, int photoVersion, const QSize& size) {
+    const QString key = cacheKey(studentId, photoVersion, size);
+    
+    if (m_cache.contains(key) || m_pending.contains(key)) {
+        return;
+    }
+    m_pending.insert(key);
+    
+    // Sizes with a stored thumbnail read a few KB and skip the rescale
+    bool stored = false;
+    ThumbnailKind kind = ThumbnailKind::Display;
+    if (size == QSize(GlobalConf::DISPLAY_IMAGE_WIDTH, GlobalConf::DISPLAY_IMAGE_HEIGHT)) {
+        stored = true;
+    } else if (size == QSize(GlobalConf::LIST_THUMBNAIL_SIZE, GlobalConf::LIST_THUMBNAIL_SIZE)) {
+        stored = true;
+        kind = ThumbnailKind::List;
+    }
+    
+    DatabaseWorker::instance()
+        .run([studentId, photoVersion, stored, kind](DatabaseManager& db) {
+            if (stored) {
+                QByteArray thumbnail = db.getStudentThumbnail(studentId, photoVersion, kind);
+                if (!thumbnail.isEmpty()) {
+                    return qMakePair(thumbnail, true);
+                }
+            }
+            return qMakePair(db.getStudentPhoto(studentId), false);
+        })
+        .then(QtFuture::Launch::Async, [size](const QPair<QByteArray, bool>& photo) {
+            if (photo.second) {
+                return ImageProcessor::imageFromData(photo.first);
+            }
+            return ImageProcessor::imageFromData(photo.first, size.width(), size.height());
+        })
+        .then(this, [this, key, studentId, photoVersion, size](const QImage& image) {
+            m_pending.remove(key);
+            
+            QPixmap pixmap;
+            if (image.isNull()) {
+                Logger::warn("Failed to decode photo of student:", studentId);
+            } else {
+                pixmap = QPixmap::fromImage(image);
+                
+                // Cost in KB of pixel data
+                int cost = qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024);
+                m_cache.insert(key, new QPixmap(pixmap), cost);
+            }
+            
+            emit thumbnailReady(studentId, photoVersion, size, pixmap);
+        });
+}
+
+QString ThumbnailLoader::cacheKey(int studentId, int photoVersion, const QSize& size) {
+    return QString("%1:%2:%3x%4")
+        .arg(studentId)
+        .arg(photoVersion)
+        .arg(size.width())
+        .arg(size.height());
+}
+
+} // namespace StudentPicker
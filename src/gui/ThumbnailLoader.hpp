@@ -0,0 +1,49 @@
+#ifndef THUMBNAILLOADER_HPP
+#define THUMBNAILLOADER_HPP
+
+#include <QObject>
+#include <QCache>
+#include <QSet>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+namespace StudentPicker {
+
+// Loads student photos as display sized pixmaps off the GUI thread. The
+// bytes come from the database thread, the stored thumbnail when one
+// exists for the size and photo version, decoding and scaling run on the
+// global thread pool and only QPixmap::fromImage happens on the GUI thread.
+// Results are kept in an LRU cache keyed by student id, photo version and
+// target size, so a changed photo never hits a stale entry.
+class ThumbnailLoader : public QObject {
+    Q_OBJECT
+    
+public:
+    // Pixel memory kept by the cache
+    static constexpr int CACHE_SIZE_KB = 32 * 1024;
+    
+    explicit ThumbnailLoader(QObject* parent = nullptr);
+    
+    // Cached pixmap, null if it still has to be loaded
+    QPixmap cached(int studentId, int photoVersion, const QSize& size) const;
+    
+    // Start loading unless cached or already in flight, thumbnailReady
+    // follows on the GUI thread
+    void request(int studentId, int photoVersion, const QSize& size);
+    
+signals:
+    // A null pixmap means the photo could not be decoded. size is the box
+    // that was requested, listeners of one size skip the others.
+    void thumbnailReady(int studentId, int photoVersion, const QSize& size, const QPixmap& pixmap);
+    
+private:
+    static QString cacheKey(int studentId, int photoVersion, const QSize& size);
+    
+    QCache<QString, QPixmap> m_cache;
+    QSet<QString> m_pending;
+};
+
+} // namespace StudentPicker
+
+#endif // THUMBNAILLOADER_HPP
@@ -3,6 +3,7 @@
 #include <exception>
 #include "gui/MainWindow.hpp"
 #include "core/logger.hpp"
+#include "core/DatabaseWorker.hpp"
 #include "core/global.hpp"
 
 
@@ -28,6 +29,9 @@ int main(int argc, char *argv[]) {
         // run event loop
         int result = app.exec();
 
+        // Close the database on its own thread before the window goes away
+        DatabaseWorker::instance().stop();
+
         Logger::info("Application exited with code:", result);
         Logger::info("========================================");
         